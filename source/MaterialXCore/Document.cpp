@@ -7,6 +7,7 @@
 
 #include <MaterialXCore/Util.h>
 
+#include <atomic>
 #include <mutex>
 
 namespace MaterialX
@@ -20,6 +21,8 @@ namespace {
 const string DOCUMENT_VERSION_STRING = std::to_string(MATERIALX_MAJOR_VERSION) + "." +
                                        std::to_string(MATERIALX_MINOR_VERSION);
 
+std::atomic<uint64_t> documentRevisionCounter(0);
+
 template<class T> shared_ptr<T> updateChildSubclass(ElementPtr parent, ElementPtr origChild)
 {
     string childName = origChild->getName();
@@ -50,15 +53,28 @@ class Document::Cache
 {
   public:
     Cache() :
-        valid(false)
+        valid(false),
+        current(false)
     {
     }
     ~Cache() { }
 
     void refresh()
     {
+        // Concurrent readers of a current cache proceed without locking.  The
+        // flag is only cleared by document edits, which are not permitted to
+        // run concurrently with readers.
+        if (current.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
         // Thread synchronization for multiple concurrent readers of a single document.
         std::lock_guard<std::mutex> guard(mutex);
+        if (current.load(std::memory_order_relaxed))
+        {
+            return;
+        }
 
         if (!valid)
         {
@@ -66,47 +82,187 @@ class Document::Cache
             portElementMap.clear();
             nodeDefMap.clear();
             implementationMap.clear();
+            pendingElements.clear();
+            pendingTrees.clear();
 
-            // Traverse the document to build a new cache.
-            for (ElementPtr elem : doc.lock()->traverseTree())
+            // Traverse the document to build a new cache, without loading
+            // its deferred elements.
+            for (ElementPtr elem : TreeIterator(doc.lock()))
             {
-                const string& nodeName = elem->getAttribute(PortElement::NODE_NAME_ATTRIBUTE);
-                const string& nodeString = elem->getAttribute(NodeDef::NODE_ATTRIBUTE);
-                const string& nodeDefString = elem->getAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE);
+                addEntries(elem, false);
+            }
 
-                if (!nodeName.empty())
-                {
-                    PortElementPtr portElem = elem->asA<PortElement>();
-                    if (portElem)
-                    {
-                        portElementMap.insert(std::pair<string, PortElementPtr>(
-                            portElem->getQualifiedName(nodeName),
-                            portElem));
-                    }
-                }
-                if (!nodeString.empty())
+            valid = true;
+        }
+        else if (!pendingElements.empty() || !pendingTrees.empty())
+        {
+            // Apply incremental updates for elements that have changed since
+            // the last refresh, skipping any that are no longer in the document.
+            for (const weak_ptr<Element>& weakElem : pendingTrees)
+            {
+                ElementPtr elem = weakElem.lock();
+                if (elem && isAttached(elem))
                 {
-                    NodeDefPtr nodeDef = elem->asA<NodeDef>();
-                    if (nodeDef)
+                    for (ElementPtr descendant : TreeIterator(elem))
                     {
-                        nodeDefMap.insert(std::pair<string, NodeDefPtr>(
-                            nodeDef->getQualifiedName(nodeString),
-                            nodeDef));
+                        addEntries(descendant, true);
                     }
                 }
-                if (!nodeDefString.empty())
+            }
+            for (const weak_ptr<Element>& weakElem : pendingElements)
+            {
+                ElementPtr elem = weakElem.lock();
+                if (elem && isAttached(elem))
                 {
-                    InterfaceElementPtr interface = elem->asA<InterfaceElement>();
-                    if (interface && (interface->isA<Implementation>() || interface->isA<NodeGraph>()))
-                    {
-                        implementationMap.insert(std::pair<string, InterfaceElementPtr>(
-                            interface->getQualifiedName(nodeDefString),
-                            interface));
-                    }
+                    addEntries(elem, true);
                 }
             }
+            pendingElements.clear();
+            pendingTrees.clear();
+        }
 
-            valid = true;
+        current.store(true, std::memory_order_release);
+    }
+
+    // Mark the given element as requiring a cache update for its own
+    // attributes.
+    void updateElement(ElementPtr elem)
+    {
+        if (valid)
+        {
+            removeEntries(elem);
+            pendingElements.push_back(elem);
+            current.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    // Mark the given element and all of its descendants as requiring a cache
+    // update, e.g. when a change of namespace affects their qualified names.
+    void updateTree(ElementPtr elem)
+    {
+        if (valid)
+        {
+            for (ElementPtr descendant : TreeIterator(elem))
+            {
+                removeEntries(descendant);
+            }
+            pendingTrees.push_back(elem);
+            current.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    // Remove the given element and all of its descendants from the cache.
+    void removeTree(ElementPtr elem)
+    {
+        if (valid)
+        {
+            for (ElementPtr descendant : TreeIterator(elem))
+            {
+                removeEntries(descendant);
+            }
+        }
+    }
+
+  private:
+    // Return true if the given element is reachable from the document root.
+    bool isAttached(ConstElementPtr elem) const
+    {
+        for (ConstElementPtr parent = elem->getParent(); parent; parent = elem->getParent())
+        {
+            if (parent->getChild(elem->getName()) != elem)
+            {
+                return false;
+            }
+            elem = parent;
+        }
+        return elem == doc.lock();
+    }
+
+    void addEntries(ElementPtr elem, bool checkDuplicates)
+    {
+        const string& nodeName = elem->getAttribute(PortElement::NODE_NAME_ATTRIBUTE);
+        const string& nodeString = elem->getAttribute(NodeDef::NODE_ATTRIBUTE);
+        const string& nodeDefString = elem->getAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE);
+
+        if (!nodeName.empty())
+        {
+            PortElementPtr portElem = elem->asA<PortElement>();
+            if (portElem)
+            {
+                addEntry(portElementMap, portElem->getQualifiedName(nodeName), portElem, checkDuplicates);
+            }
+        }
+        if (!nodeString.empty())
+        {
+            NodeDefPtr nodeDef = elem->asA<NodeDef>();
+            if (nodeDef)
+            {
+                addEntry(nodeDefMap, nodeDef->getQualifiedName(nodeString), nodeDef, checkDuplicates);
+            }
+        }
+        if (!nodeDefString.empty())
+        {
+            InterfaceElementPtr interface = elem->asA<InterfaceElement>();
+            if (interface && (interface->isA<Implementation>() || interface->isA<NodeGraph>()))
+            {
+                addEntry(implementationMap, interface->getQualifiedName(nodeDefString), interface, checkDuplicates);
+            }
+        }
+    }
+
+    void removeEntries(ElementPtr elem)
+    {
+        const string& nodeName = elem->getAttribute(PortElement::NODE_NAME_ATTRIBUTE);
+        const string& nodeString = elem->getAttribute(NodeDef::NODE_ATTRIBUTE);
+        const string& nodeDefString = elem->getAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE);
+
+        if (!nodeName.empty())
+        {
+            removeEntry(portElementMap, elem->getQualifiedName(nodeName), elem);
+        }
+        if (!nodeString.empty())
+        {
+            removeEntry(nodeDefMap, elem->getQualifiedName(nodeString), elem);
+        }
+        if (!nodeDefString.empty())
+        {
+            removeEntry(implementationMap, elem->getQualifiedName(nodeDefString), elem);
+        }
+    }
+
+    template<class T> static void addEntry(std::unordered_map<string, vector<shared_ptr<T>>>& map,
+                                           const string& key,
+                                           shared_ptr<T> elem,
+                                           bool checkDuplicates)
+    {
+        vector<shared_ptr<T>>& entries = map[key];
+        if (!checkDuplicates || std::find(entries.begin(), entries.end(), elem) == entries.end())
+        {
+            entries.push_back(elem);
+        }
+    }
+
+    template<class T> static void removeEntry(std::unordered_map<string, vector<shared_ptr<T>>>& map,
+                                              const string& key,
+                                              ConstElementPtr elem)
+    {
+        auto it = map.find(key);
+        if (it == map.end())
+        {
+            return;
+        }
+        vector<shared_ptr<T>>& entries = it->second;
+        for (auto entry = entries.begin(); entry != entries.end(); ++entry)
+        {
+            if (*entry == elem)
+            {
+                entries.erase(entry);
+                break;
+            }
+        }
+        if (entries.empty())
+        {
+            map.erase(it);
         }
     }
 
@@ -114,9 +270,113 @@ class Document::Cache
     weak_ptr<Document> doc;
     std::mutex mutex;
     bool valid;
-    std::unordered_multimap<string, PortElementPtr> portElementMap;
-    std::unordered_multimap<string, NodeDefPtr> nodeDefMap;
-    std::unordered_multimap<string, InterfaceElementPtr> implementationMap;
+    std::atomic<bool> current;
+    std::unordered_map<string, vector<PortElementPtr>> portElementMap;
+    std::unordered_map<string, vector<NodeDefPtr>> nodeDefMap;
+    std::unordered_map<string, vector<InterfaceElementPtr>> implementationMap;
+
+  private:
+    vector<weak_ptr<Element>> pendingElements;
+    vector<weak_ptr<Element>> pendingTrees;
+};
+
+//
+// Document deferred elements
+//
+
+class Document::DeferredElements
+{
+  public:
+    DeferredElements() :
+        pendingCount(0),
+        loading(false)
+    {
+    }
+    ~DeferredElements() { }
+
+    struct Entry
+    {
+        string name;
+        string node;
+        string nodeDef;
+        DeferredElementLoader loader;
+        bool loaded;
+    };
+
+    void addEntry(const Entry& entry)
+    {
+        if (nameMap.count(entry.name))
+        {
+            throw Exception("Duplicate deferred element: " + entry.name);
+        }
+        size_t index = entries.size();
+        entries.push_back(entry);
+        nameMap[entry.name] = index;
+        if (!entry.node.empty())
+        {
+            nodeMap[entry.node].push_back(index);
+        }
+        if (!entry.nodeDef.empty())
+        {
+            nodeDefMap[entry.nodeDef].push_back(index);
+        }
+        pendingCount++;
+    }
+
+    // Load the entry with the given index into the given document, if it
+    // has not already been loaded.
+    void loadEntry(size_t index, DocumentPtr doc)
+    {
+        Entry& entry = entries[index];
+        if (entry.loaded)
+        {
+            return;
+        }
+        entry.loaded = true;
+        pendingCount--;
+        bool wasLoading = loading;
+        loading = true;
+        try
+        {
+            entry.loader(doc);
+        }
+        catch (...)
+        {
+            loading = wasLoading;
+            throw;
+        }
+        loading = wasLoading;
+    }
+
+    void loadEntries(const std::unordered_map<string, vector<size_t>>& map, const string& key, DocumentPtr doc)
+    {
+        auto it = map.find(key);
+        if (it != map.end())
+        {
+            for (size_t index : it->second)
+            {
+                loadEntry(index, doc);
+            }
+        }
+    }
+
+    void clear()
+    {
+        entries.clear();
+        nameMap.clear();
+        nodeMap.clear();
+        nodeDefMap.clear();
+        pendingCount = 0;
+    }
+
+  public:
+    std::recursive_mutex mutex;
+    std::atomic<size_t> pendingCount;
+    bool loading;
+    vector<Entry> entries;
+    std::unordered_map<string, size_t> nameMap;
+    std::unordered_map<string, vector<size_t>> nodeMap;
+    std::unordered_map<string, vector<size_t>> nodeDefMap;
 };
 
 //
@@ -125,8 +385,13 @@ class Document::Cache
 
 Document::Document(ElementPtr parent, const string& name) :
     GraphElement(parent, CATEGORY, name),
-    _cache(std::unique_ptr<Cache>(new Cache))
+    _cache(std::unique_ptr<Cache>(new Cache)),
+    _deferredElements(std::unique_ptr<DeferredElements>(new DeferredElements)),
+    _revision(0),
+    _frozen(false),
+    _updateDepth(0)
 {
+    updateRevision();
 }
 
 Document::~Document()
@@ -139,6 +404,8 @@ void Document::initialize()
 
     DocumentPtr doc = getDocument();
     _cache->doc = doc;
+    _dataLibrary = nullptr;
+    _deferredElements->clear();
 
     clearContent();
     setVersionString(DOCUMENT_VERSION_STRING);
@@ -146,6 +413,9 @@ void Document::initialize()
 
 void Document::importLibrary(const ConstDocumentPtr& library, const CopyOptions* copyOptions)
 {
+    // Deferred elements of the library are loaded before it is imported.
+    library->loadDeferredElements();
+
     bool skipConflictingElements = copyOptions && copyOptions->skipConflictingElements;
     for (const ConstElementPtr& child : library->getChildren())
     {
@@ -218,15 +488,8 @@ vector<PortElementPtr> Document::getMatchingPorts(const string& nodeName) const
     _cache->refresh();
 
     // Find all port elements matching the given node name.
-    vector<PortElementPtr> ports;
-    auto keyRange = _cache->portElementMap.equal_range(nodeName);
-    for (auto it = keyRange.first; it != keyRange.second; ++it)
-    {
-        ports.push_back(it->second);
-    }
-
-    // Return the matches.
-    return ports;
+    auto it = _cache->portElementMap.find(nodeName);
+    return (it != _cache->portElementMap.end()) ? it->second : vector<PortElementPtr>();
 }
 
 ValuePtr Document::getGeomAttrValue(const string& geomAttrName, const string& geom) const
@@ -247,17 +510,106 @@ ValuePtr Document::getGeomAttrValue(const string& geomAttrName, const string& ge
     return value;
 }
 
+void Document::setDataLibrary(const ConstDocumentPtr& library)
+{
+    checkMutable();
+    if (library)
+    {
+        // Referenced libraries are shared between documents, so they are
+        // frozen against further edits.
+        std::const_pointer_cast<Document>(library)->freeze();
+    }
+    _dataLibrary = library;
+    updateRevision();
+}
+
+void Document::addDeferredElement(const string& name, const string& node, const string& nodeDef,
+                                  DeferredElementLoader loader)
+{
+    checkMutable();
+    std::lock_guard<std::recursive_mutex> guard(_deferredElements->mutex);
+    _deferredElements->addEntry({ name, node, nodeDef, loader, false });
+    updateRevision();
+}
+
+bool Document::hasDeferredElement(const string& name) const
+{
+    if (!getDeferredElementCount())
+    {
+        return false;
+    }
+    std::lock_guard<std::recursive_mutex> guard(_deferredElements->mutex);
+    auto it = _deferredElements->nameMap.find(name);
+    return it != _deferredElements->nameMap.end() && !_deferredElements->entries[it->second].loaded;
+}
+
+size_t Document::getDeferredElementCount() const
+{
+    return _deferredElements->pendingCount.load(std::memory_order_acquire);
+}
+
+void Document::loadDeferredElement(const string& name) const
+{
+    if (!getDeferredElementCount())
+    {
+        return;
+    }
+    std::lock_guard<std::recursive_mutex> guard(_deferredElements->mutex);
+    auto it = _deferredElements->nameMap.find(name);
+    if (it != _deferredElements->nameMap.end())
+    {
+        _deferredElements->loadEntry(it->second, std::const_pointer_cast<Document>(getDocument()));
+    }
+}
+
+void Document::loadDeferredElements() const
+{
+    if (!getDeferredElementCount())
+    {
+        return;
+    }
+    std::lock_guard<std::recursive_mutex> guard(_deferredElements->mutex);
+    DocumentPtr doc = std::const_pointer_cast<Document>(getDocument());
+    for (size_t i = 0; i < _deferredElements->entries.size(); i++)
+    {
+        _deferredElements->loadEntry(i, doc);
+    }
+}
+
+void Document::copyDeferredElements(const Document& doc)
+{
+    std::lock_guard<std::recursive_mutex> guard(doc._deferredElements->mutex);
+    for (const DeferredElements::Entry& entry : doc._deferredElements->entries)
+    {
+        if (!entry.loaded)
+        {
+            addDeferredElement(entry.name, entry.node, entry.nodeDef, entry.loader);
+        }
+    }
+}
+
 vector<NodeDefPtr> Document::getMatchingNodeDefs(const string& nodeName) const
 {
+    // Load matching deferred elements.
+    if (getDeferredElementCount())
+    {
+        std::lock_guard<std::recursive_mutex> guard(_deferredElements->mutex);
+        _deferredElements->loadEntries(_deferredElements->nodeMap, nodeName,
+                                       std::const_pointer_cast<Document>(getDocument()));
+    }
+
     // Refresh the cache.
     _cache->refresh();
 
     // Find all nodedefs matching the given node name.
-    vector<NodeDefPtr> nodeDefs;
-    auto keyRange = _cache->nodeDefMap.equal_range(nodeName);
-    for (auto it = keyRange.first; it != keyRange.second; ++it)
+    auto it = _cache->nodeDefMap.find(nodeName);
+    vector<NodeDefPtr> nodeDefs = (it != _cache->nodeDefMap.end()) ? it->second : vector<NodeDefPtr>();
+
+    // Append matches from the referenced data library.
+    if (_dataLibrary)
     {
-        nodeDefs.push_back(it->second);
+        vector<NodeDefPtr> libraryMatches = _dataLibrary->getMatchingNodeDefs(nodeName);
+        nodeDefs.insert(nodeDefs.end(), libraryMatches.begin(), libraryMatches.end());
     }
 
     // Return the matches.
@@ -266,26 +618,69 @@ vector<NodeDefPtr> Document::getMatchingNodeDefs(const string& nodeName) const
 
 vector<InterfaceElementPtr> Document::getMatchingImplementations(const string& nodeDef) const
 {
+    // Load matching deferred elements.
+    if (getDeferredElementCount())
+    {
+        std::lock_guard<std::recursive_mutex> guard(_deferredElements->mutex);
+        _deferredElements->loadEntries(_deferredElements->nodeDefMap, nodeDef,
+                                       std::const_pointer_cast<Document>(getDocument()));
+    }
+
     // Refresh the cache.
     _cache->refresh();
 
     // Find all implementations matching the given nodedef string.
-    vector<InterfaceElementPtr> implementations;
-    auto keyRange = _cache->implementationMap.equal_range(nodeDef);
-    for (auto it = keyRange.first; it != keyRange.second; ++it)
+    auto it = _cache->implementationMap.find(nodeDef);
+    vector<InterfaceElementPtr> implementations = (it != _cache->implementationMap.end()) ? it->second : vector<InterfaceElementPtr>();
+
+    // Append matches from the referenced data library.
+    if (_dataLibrary)
     {
-        implementations.push_back(it->second);
+        vector<InterfaceElementPtr> libraryMatches = _dataLibrary->getMatchingImplementations(nodeDef);
+        implementations.insert(implementations.end(), libraryMatches.begin(), libraryMatches.end());
     }
 
     // Return the matches.
     return implementations;
 }
 
+uint64_t Document::getRevision() const
+{
+    uint64_t revision = _revision.load(std::memory_order_acquire);
+    if (_dataLibrary)
+    {
+        revision = std::max(revision, _dataLibrary->getRevision());
+    }
+    return revision;
+}
+
 bool Document::validate(string* message) const
 {
+    return validateParallel(message, 1);
+}
+
+bool Document::validateParallel(string* message, unsigned int threadCount) const
+{
+    // Load deferred elements up front, since lookups within validation would
+    // otherwise load them while the children of the document are being
+    // validated.
+    loadDeferredElements();
+
+    // For parallel validation, also load the deferred elements of the data
+    // libraries and warm the caches of all documents, so that concurrent
+    // lookups proceed without modifying them.
+    if (getWorkerThreadCount(threadCount, getChildren().size()) > 1)
+    {
+        for (ConstDocumentPtr doc = getDocument(); doc; doc = doc->getDataLibrary())
+        {
+            doc->loadDeferredElements();
+            doc->_cache->refresh();
+        }
+    }
+
     bool res = true;
     validateRequire(hasVersionString(), res, message, "Missing version string");
-    return GraphElement::validate(message) && res;
+    return validateElement(message, threadCount) && res;
 }
 
 void Document::upgradeVersion()
@@ -786,34 +1181,99 @@ void Document::upgradeVersion()
     }
 }
 
-void Document::onAddElement(ElementPtr, ElementPtr)
+void Document::updateRevision()
 {
-    _cache->valid = false;
+    // Deferred elements may be loaded concurrently by readers, so the
+    // revision is only ever advanced.
+    uint64_t revision = ++documentRevisionCounter;
+    uint64_t current = _revision.load(std::memory_order_relaxed);
+    while (current < revision && !_revision.compare_exchange_weak(current, revision))
+    {
+    }
 }
 
-void Document::onRemoveElement(ElementPtr, ElementPtr)
+void Document::endUpdateScope()
 {
-    _cache->valid = false;
+    if (--_updateDepth || _pendingChildOrders.empty())
+    {
+        return;
+    }
+    vector<ElementPtr> pending;
+    pending.swap(_pendingChildOrders);
+    for (const ElementPtr& elem : pending)
+    {
+        elem->updateChildOrder();
+    }
+}
+
+void Document::checkMutable() const
+{
+    if (isFrozen() && !_deferredElements->loading)
+    {
+        throw Exception("Cannot modify a frozen document: " + getSourceUri());
+    }
 }
 
-void Document::onSetAttribute(ElementPtr, const string&, const string&)
+void Document::onAddElement(ElementPtr, ElementPtr elem)
 {
-    _cache->valid = false;
+    checkMutable();
+    _cache->updateElement(elem);
+    updateRevision();
 }
 
-void Document::onRemoveAttribute(ElementPtr, const string&)
+void Document::onRemoveElement(ElementPtr, ElementPtr elem)
 {
-    _cache->valid = false;
+    checkMutable();
+    _cache->removeTree(elem);
+    updateRevision();
 }
 
-void Document::onCopyContent(ElementPtr)
+void Document::onSetAttribute(ElementPtr elem, const string& attrib, const string&)
 {
-    _cache->valid = false;
+    checkMutable();
+    updateRevision();
+    if (attrib == Element::NAMESPACE_ATTRIBUTE)
+    {
+        _cache->updateTree(elem);
+    }
+    else if (attrib == PortElement::NODE_NAME_ATTRIBUTE ||
+             attrib == NodeDef::NODE_ATTRIBUTE ||
+             attrib == InterfaceElement::NODE_DEF_ATTRIBUTE)
+    {
+        _cache->updateElement(elem);
+    }
+}
+
+void Document::onRemoveAttribute(ElementPtr elem, const string& attrib)
+{
+    Document::onSetAttribute(elem, attrib, EMPTY_STRING);
+}
+
+void Document::onSetChildOrder(ElementPtr)
+{
+    checkMutable();
+    updateRevision();
+}
+
+void Document::onCopyContent(ElementPtr elem)
+{
+    checkMutable();
+    updateRevision();
+    if (elem->getChildren().empty())
+    {
+        _cache->updateElement(elem);
+    }
+    else
+    {
+        _cache->updateTree(elem);
+    }
 }
 
-void Document::onClearContent(ElementPtr)
+void Document::onClearContent(ElementPtr elem)
 {
-    _cache->valid = false;
+    checkMutable();
+    _cache->updateTree(elem);
+    updateRevision();
 }
 
 } // namespace MaterialX
@@ -16,6 +16,8 @@
 #include <MaterialXCore/Node.h>
 #include <MaterialXCore/Variant.h>
 
+#include <atomic>
+
 namespace MaterialX
 {
 
@@ -26,11 +28,20 @@ using DocumentPtr = shared_ptr<Document>;
 /// A shared pointer to a const Document
 using ConstDocumentPtr = shared_ptr<const Document>;
 
+/// A function that adds the content of a deferred element to the given
+/// document.
+using DeferredElementLoader = std::function<void(DocumentPtr)>;
+
 /// @class Document
 /// A MaterialX document, which represents the top-level element in the
 /// MaterialX ownership hierarchy.
 ///
 /// Use the factory function createDocument() to create a Document instance.
+///
+/// The lookup methods getMatchingPorts, getMatchingNodeDefs and
+/// getMatchingImplementations may be called concurrently from multiple
+/// threads, provided that the document is not modified during these calls
+/// and that it has no deferred elements waiting to be loaded.
 class Document : public GraphElement
 {
   public:
@@ -53,12 +64,15 @@ class Document : public GraphElement
     {
         DocumentPtr doc = createDocument<Document>();
         doc->copyContentFrom(getSelf());
+        doc->setDataLibrary(getDataLibrary());
+        doc->copyDeferredElements(*this);
         return doc;
     }
 
     /// Import the given document as a library within this document.
     /// The contents of the library document are copied into this one, and
-    /// are assigned the source URI of the library.
+    /// are assigned the source URI of the library.  Deferred elements of the
+    /// library are loaded before its contents are copied.
     /// @param library The library document to be imported.
     /// @param copyOptions An optional pointer to a CopyOptions object.
     ///    If provided, then the given options will affect the behavior of the
@@ -68,6 +82,96 @@ class Document : public GraphElement
     /// Get a list of source URI's referenced by the document
     StringSet getReferencedSourceUris() const;
 
+    /// @name Data Library
+    /// @{
+
+    /// Set the data library referenced by this document.  Rather than copying
+    /// library content as importLibrary does, a referenced data library is
+    /// shared between documents, and is searched by element lookups such as
+    /// getNodeDef, getImplementation, getMatchingNodeDefs and
+    /// getMatchingImplementations when no match is found in this document.
+    /// Lookups that return all elements of a category, such as getNodeDefs,
+    /// only consider the content of this document.
+    /// @param library The library document to be referenced.  The library is
+    ///    frozen by this call, so that it may be safely shared, and any
+    ///    subsequent attempt to modify it throws an Exception.  A library may
+    ///    itself reference a further data library.
+    /// @throws Exception if this document is frozen.
+    void setDataLibrary(const ConstDocumentPtr& library);
+
+    /// Return the data library, if any, referenced by this document.
+    ConstDocumentPtr getDataLibrary() const
+    {
+        return _dataLibrary;
+    }
+
+    /// Return true if this document references a data library.
+    bool hasDataLibrary() const
+    {
+        return _dataLibrary != nullptr;
+    }
+
+    /// @}
+    /// @name Frozen Documents
+    /// @{
+
+    /// Freeze the document, so that any subsequent attempt to modify its
+    /// content, attributes or data library throws an Exception.  Deferred
+    /// elements of a frozen document are still loaded on demand.  A frozen
+    /// document cannot be unfrozen, but its copies are editable.
+    void freeze()
+    {
+        _frozen.store(true, std::memory_order_release);
+    }
+
+    /// Return true if the document has been frozen.
+    bool isFrozen() const
+    {
+        return _frozen.load(std::memory_order_acquire);
+    }
+
+    /// @}
+    /// @name Deferred Elements
+    /// @{
+
+    /// Register a deferred element at the root scope of this document, whose
+    /// content is loaded on demand when the element is first resolved: by name
+    /// through getNodeDef, getImplementation or a name reference such as a
+    /// nodedef string, by node through getMatchingNodeDefs, or by nodedef
+    /// through getMatchingImplementations.  Until it is loaded, a deferred
+    /// element is not a child of the document.  All deferred elements of a
+    /// document are loaded before it is traversed by traverseTree, validated
+    /// or written, and before lookups that return all elements of a category,
+    /// such as getNodeDefs, so that these see the complete document.
+    /// @param name The qualified name of the deferred element.
+    /// @param node The qualified node string of a deferred NodeDef, or an
+    ///    empty string.
+    /// @param nodeDef The qualified nodedef string of a deferred Implementation
+    ///    or NodeGraph, or an empty string.
+    /// @param loader A function that adds the element to the given document.
+    /// @throws Exception if a deferred element with the given name has already
+    ///    been registered.
+    void addDeferredElement(const string& name, const string& node, const string& nodeDef,
+                            DeferredElementLoader loader);
+
+    /// Return true if a deferred element with the given name is waiting to
+    /// be loaded.
+    bool hasDeferredElement(const string& name) const;
+
+    /// Return the number of deferred elements waiting to be loaded.
+    size_t getDeferredElementCount() const;
+
+    /// Load the deferred element, if any, with the given name.
+    void loadDeferredElement(const string& name) const;
+
+    /// Load all deferred elements in the order they were registered.  Since
+    /// lookups may load deferred elements into the document, this should be
+    /// called before iterating over the children of a document while
+    /// performing lookups.
+    void loadDeferredElements() const;
+
+    /// @}
+
     /// @name NodeGraph Elements
     /// @{
 
@@ -81,15 +185,18 @@ class Document : public GraphElement
         return addChild<NodeGraph>(name);
     }
 
-    /// Return the NodeGraph, if any, with the given name.
+    /// Return the NodeGraph, if any, with the given name.  If no match is found,
+    /// then the referenced data library, if any, is searched.
     NodeGraphPtr getNodeGraph(const string& name) const
     {
-        return getChildOfType<NodeGraph>(name);
+        return getLibraryChildOfType<NodeGraph>(name);
     }
 
-    /// Return a vector of all NodeGraph elements in the document.
+    /// Return a vector of all NodeGraph elements in the document, loading any
+    /// deferred elements of the document.
     vector<NodeGraphPtr> getNodeGraphs() const
     {
+        loadDeferredElements();
         return getChildrenOfType<NodeGraph>();
     }
 
@@ -189,10 +296,11 @@ class Document : public GraphElement
         return geomPropDef;
     }
 
-    /// Return the GeomPropDef, if any, with the given name.
+    /// Return the GeomPropDef, if any, with the given name.  If no match is found,
+    /// then the referenced data library, if any, is searched.
     GeomPropDefPtr getGeomPropDef(const string& name) const
     {
-        return getChildOfType<GeomPropDef>(name);
+        return getLibraryChildOfType<GeomPropDef>(name);
     }
 
     /// Return a vector of all GeomPropDef elements in the document.
@@ -317,10 +425,11 @@ class Document : public GraphElement
         return addChild<TypeDef>(name);
     }
 
-    /// Return the TypeDef, if any, with the given name.
+    /// Return the TypeDef, if any, with the given name.  If no match is found,
+    /// then the referenced data library, if any, is searched.
     TypeDefPtr getTypeDef(const string& name) const
     {
-        return getChildOfType<TypeDef>(name);
+        return getLibraryChildOfType<TypeDef>(name);
     }
 
     /// Return a vector of all TypeDef elements in the document.
@@ -362,15 +471,18 @@ class Document : public GraphElement
         return child;
     }
 
-    /// Return the NodeDef, if any, with the given name.
+    /// Return the NodeDef, if any, with the given name.  If no match is found,
+    /// then the referenced data library, if any, is searched.
     NodeDefPtr getNodeDef(const string& name) const
     {
-        return getChildOfType<NodeDef>(name);
+        return getLibraryChildOfType<NodeDef>(name);
     }
 
-    /// Return a vector of all NodeDef elements in the document.
+    /// Return a vector of all NodeDef elements in the document, loading any
+    /// deferred elements of the document.
     vector<NodeDefPtr> getNodeDefs() const
     {
+        loadDeferredElements();
         return getChildrenOfType<NodeDef>();
     }
 
@@ -381,6 +493,8 @@ class Document : public GraphElement
     }
 
     /// Return a vector of all NodeDef elements that match the given node name.
+    /// Matches within the referenced data library, if any, follow those
+    /// within this document.
     vector<NodeDefPtr> getMatchingNodeDefs(const string& nodeName) const;
 
     /// @}
@@ -461,15 +575,18 @@ class Document : public GraphElement
         return addChild<Implementation>(name);
     }
 
-    /// Return the Implementation, if any, with the given name.
+    /// Return the Implementation, if any, with the given name.  If no match is found,
+    /// then the referenced data library, if any, is searched.
     ImplementationPtr getImplementation(const string& name) const
     {
-        return getChildOfType<Implementation>(name);
+        return getLibraryChildOfType<Implementation>(name);
     }
 
-    /// Return a vector of all Implementation elements in the document.
+    /// Return a vector of all Implementation elements in the document, loading any
+    /// deferred elements of the document.
     vector<ImplementationPtr> getImplementations() const
     {
+        loadDeferredElements();
         return getChildrenOfType<Implementation>();
     }
 
@@ -481,7 +598,8 @@ class Document : public GraphElement
 
     /// Return a vector of all node implementations that match the given
     /// NodeDef string.  Note that a node implementation may be either an
-    /// Implementation element or NodeGraph element.
+    /// Implementation element or NodeGraph element.  Matches within the
+    /// referenced data library, if any, follow those within this document.
     vector<InterfaceElementPtr> getMatchingImplementations(const string& nodeDef) const;
 
     /// @}
@@ -497,10 +615,11 @@ class Document : public GraphElement
         return addChild<UnitDef>(name);
     }
 
-    /// Return the UnitDef, if any, with the given name.
+    /// Return the UnitDef, if any, with the given name.  If no match is found,
+    /// then the referenced data library, if any, is searched.
     UnitDefPtr getUnitDef(const string& name) const
     {
-        return getChildOfType<UnitDef>(name);
+        return getLibraryChildOfType<UnitDef>(name);
     }
 
     /// Return a vector of all Member elements in the TypeDef.
@@ -528,10 +647,11 @@ class Document : public GraphElement
         return addChild<UnitTypeDef>(name);
     }
 
-    /// Return the UnitTypeDef, if any, with the given name.
+    /// Return the UnitTypeDef, if any, with the given name.  If no match is found,
+    /// then the referenced data library, if any, is searched.
     UnitTypeDefPtr getUnitTypeDef(const string& name) const
     {
-        return getChildOfType<UnitTypeDef>(name);
+        return getLibraryChildOfType<UnitTypeDef>(name);
     }
 
     /// Return a vector of all UnitTypeDef elements in the document.
@@ -601,6 +721,17 @@ class Document : public GraphElement
         return getAttribute(CMS_CONFIG_ATTRIBUTE);
     }
 
+    /// @}
+    /// @name Revision
+    /// @{
+
+    /// Return the revision of this document, which increases whenever the
+    /// document or its data library is edited, or a different data library is
+    /// referenced.  Revisions are drawn from a counter shared by all documents,
+    /// so a revision observed for one state of a document is never observed
+    /// again for a different state.
+    uint64_t getRevision() const;
+
     /// @}
     /// @name Validation
     /// @{
@@ -612,6 +743,18 @@ class Document : public GraphElement
     /// @return True if the document passes all tests, false otherwise.
     bool validate(string* message = nullptr) const override;
 
+    /// Validate that the given document is consistent with the MaterialX
+    /// specification, validating its top-level elements in parallel on a pool
+    /// of worker threads.  Messages are merged in document order, so that the
+    /// result matches that of validate.  Deferred elements of the document and
+    /// of its data libraries are loaded before validation begins.
+    /// @param message An optional output string, to which a description of
+    ///    each error will be appended.
+    /// @param threadCount The maximum number of worker threads, where zero
+    ///    selects the hardware concurrency.  Defaults to zero.
+    /// @return True if the document passes all tests, false otherwise.
+    bool validateParallel(string* message = nullptr, unsigned int threadCount = 0) const;
+
     /// @}
     /// @name Callbacks
     /// @{
@@ -628,6 +771,9 @@ class Document : public GraphElement
     /// Called when an attribute of an element is removed.
     virtual void onRemoveAttribute(ElementPtr elem, const string& attrib);
 
+    /// Called when the children of an element are reordered.
+    virtual void onSetChildOrder(ElementPtr elem);
+
     /// Called when content is copied into an element.
     virtual void onCopyContent(ElementPtr elem);
 
@@ -659,26 +805,76 @@ class Document : public GraphElement
     static const string CMS_ATTRIBUTE;
     static const string CMS_CONFIG_ATTRIBUTE;
 
+  protected:
+    // Copy the deferred elements of the given document that are waiting to
+    // be loaded.
+    void copyDeferredElements(const Document& doc);
+
+  private:
+    // Return the child element, if any, with the given name and subclass,
+    // searching the referenced data library if no match is found.
+    template<class T> shared_ptr<T> getLibraryChildOfType(const string& name) const
+    {
+        loadDeferredElement(name);
+        shared_ptr<T> child = getChildOfType<T>(name);
+        if (!child)
+        {
+            ElementPtr libraryChild = getDataLibraryChild(name);
+            child = libraryChild ? libraryChild->asA<T>() : nullptr;
+        }
+        return child;
+    }
+
+    // Advance the revision of this document.
+    void updateRevision();
+
+    // Throw an exception if the document is frozen, unless a deferred
+    // element is being loaded.
+    void checkMutable() const;
+
+    // Begin and end a scope of document updates, removing the empty slots
+    // left by removed children once the outermost scope has ended.
+    void beginUpdateScope()
+    {
+        _updateDepth++;
+    }
+    void endUpdateScope();
+
   private:
     class Cache;
+    class DeferredElements;
     std::unique_ptr<Cache> _cache;
+    std::unique_ptr<DeferredElements> _deferredElements;
+    ConstDocumentPtr _dataLibrary;
+    std::atomic<uint64_t> _revision;
+    std::atomic<bool> _frozen;
+    size_t _updateDepth;
+    vector<ElementPtr> _pendingChildOrders;
+
+    friend class Element;
+    friend class ScopedUpdate;
 };
 
 /// @class ScopedUpdate
 /// An RAII class for Document updates.
 ///
 /// A ScopedUpdate instance calls Document::onBeginUpdate when created, and
-/// Document::onEndUpdate when destroyed.
+/// Document::onEndUpdate when destroyed.  Child elements removed within the
+/// outermost ScopedUpdate of a document are compacted from the child order
+/// of their parents together when it is destroyed, so large batches of
+/// removals may be wrapped in a ScopedUpdate for efficiency.
 class ScopedUpdate
 {
   public:
     explicit ScopedUpdate(DocumentPtr doc) :
         _doc(doc)
     {
+        _doc->beginUpdateScope();
         _doc->onBeginUpdate();
     }
     ~ScopedUpdate()
     {
+        _doc->endUpdateScope();
         _doc->onEndUpdate();
     }
 
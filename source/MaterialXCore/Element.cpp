@@ -9,6 +9,8 @@
 #include <MaterialXCore/Node.h>
 #include <MaterialXCore/Util.h>
 
+#include <stdexcept>
+
 namespace MaterialX
 {
 
@@ -48,20 +50,16 @@ Element::CreatorMap Element::_creatorMap;
 
 bool Element::operator==(const Element& rhs) const
 {
-    if (getCategory() != rhs.getCategory() ||
+    if (_category != rhs._category ||
         getName() != rhs.getName())
     {
         return false;
     }
 
-    // Compare attributes.
-    if (getAttributeNames() != rhs.getAttributeNames())
+    // Compare attributes.  Attribute names are interned, so they may be
+    // compared by address.
+    if (_attributes != rhs._attributes)
         return false;
-    for (const string& attr : rhs.getAttributeNames())
-    {
-        if (getAttribute(attr) != rhs.getAttribute(attr))
-            return false;
-    }
 
     // Compare children.
     const vector<ElementPtr>& c1 = getChildren();
@@ -169,6 +167,7 @@ void Element::registerChildElement(ElementPtr child)
     doc->onAddElement(getSelf(), child);
 
     _childMap[child->getName()] = child;
+    child->_childIndex = _childOrder.size();
     _childOrder.push_back(child);
 }
 
@@ -181,37 +180,137 @@ void Element::unregisterChildElement(ElementPtr child)
     doc->onRemoveElement(getSelf(), child);
 
     _childMap.erase(child->getName());
-    _childOrder.erase(
-        std::find(_childOrder.begin(), _childOrder.end(), child));
+    size_t index = findChildIndex(child.get());
+
+    // A removal outside of any enclosing update is applied directly.
+    if (doc->_updateDepth == 1 && !_removedChildCount)
+    {
+        _childOrder.erase(_childOrder.begin() + index);
+        return;
+    }
+
+    // Within an enclosing update, the empty slot is removed at the end of the
+    // outermost update scope, or earlier once half of the slots are empty, so
+    // that the cost of repeated removals remains amortized constant.
+    _childOrder[index] = nullptr;
+    if (!_removedChildCount++)
+    {
+        doc->_pendingChildOrders.push_back(getSelf());
+    }
+    if (_removedChildCount * 2 > _childOrder.size())
+    {
+        updateChildOrder();
+    }
+}
+
+void Element::updateChildOrder() const
+{
+    if (!_removedChildCount)
+    {
+        return;
+    }
+
+    // Children before the first empty slot keep their indices.  The stored
+    // indices of later children are updated when a batch of removals is
+    // applied, and are otherwise left for findChildIndex to correct, since
+    // writing to each shifted child would dominate the cost of a single
+    // removal.
+    bool updateIndices = _removedChildCount > 1;
+    size_t count = 0;
+    while (_childOrder[count])
+    {
+        count++;
+    }
+    for (size_t i = count + 1; i < _childOrder.size(); i++)
+    {
+        if (_childOrder[i])
+        {
+            if (updateIndices)
+            {
+                _childOrder[i]->_childIndex = count;
+            }
+            _childOrder[count++] = std::move(_childOrder[i]);
+        }
+    }
+    _childOrder.resize(count);
+    _removedChildCount = 0;
+}
+
+size_t Element::findChildIndex(const Element* child) const
+{
+    // Removals only move children toward the front of the child order, so a
+    // stale index is searched downward first.
+    size_t index = std::min(child->_childIndex, _childOrder.size() - 1);
+    for (size_t i = index + 1; i-- > 0; )
+    {
+        if (_childOrder[i].get() == child)
+        {
+            return i;
+        }
+    }
+    for (size_t i = index + 1; i < _childOrder.size(); i++)
+    {
+        if (_childOrder[i].get() == child)
+        {
+            return i;
+        }
+    }
+    throw Exception("Child not found in child order: " + child->getName());
 }
 
 int Element::getChildIndex(const string& name) const
 {
     ElementPtr child = getChild(name);
-    vector<ElementPtr>::const_iterator it = std::find(_childOrder.begin(), _childOrder.end(), child);
-    if (it == _childOrder.end())
+    if (!child)
     {
         return -1;
     }
-    return (int) std::distance(_childOrder.begin(), it);
+    if (_removedChildCount)
+    {
+        updateChildOrder();
+    }
+    return (int) findChildIndex(child.get());
 }
 
 void Element::setChildIndex(const string& name, int index)
 {
     ElementPtr child = getChild(name);
-    vector<ElementPtr>::iterator it = std::find(_childOrder.begin(), _childOrder.end(), child);
-    if (it == _childOrder.end())
+    if (!child)
     {
         return;
     }
 
-    if (index < 0 || index > (int) _childOrder.size())
+    const vector<ElementPtr>& children = getChildren();
+    if (index < 0 || index > (int) children.size())
     {
         throw Exception("Invalid child index");
     }
 
-    _childOrder.erase(it);
-    _childOrder.insert(_childOrder.begin() + (size_t) index, child);
+    size_t oldIndex = findChildIndex(child.get());
+    size_t newIndex = std::min((size_t) index, children.size() - 1);
+    if (oldIndex == newIndex)
+    {
+        return;
+    }
+
+    // Handle change notifications.
+    DocumentPtr doc = getDocument();
+    ScopedUpdate update(doc);
+    doc->onSetChildOrder(getSelf());
+
+    // Shift the children in between by one slot, leaving their stored
+    // indices to be corrected by findChildIndex.
+    auto begin = _childOrder.begin();
+    if (oldIndex < newIndex)
+    {
+        std::move(begin + oldIndex + 1, begin + newIndex + 1, begin + oldIndex);
+    }
+    else
+    {
+        std::move_backward(begin + newIndex, begin + oldIndex, begin + oldIndex + 1);
+    }
+    _childOrder[newIndex] = child;
+    child->_childIndex = newIndex;
 }
 
 void Element::removeChild(const string& name)
@@ -233,17 +332,22 @@ void Element::setAttribute(const string& attrib, const string& value)
     ScopedUpdate update(doc);
     doc->onSetAttribute(getSelf(), attrib, value);
 
-    if (!_attributeMap.count(attrib))
+    for (Attribute& attr : _attributes)
     {
-        _attributeOrder.push_back(attrib);
+        if (*attr.first == attrib)
+        {
+            attr.second = value;
+            return;
+        }
     }
-    _attributeMap[attrib] = value;
+    _attributes.emplace_back(&internString(attrib), value);
 }
 
 void Element::removeAttribute(const string& attrib)
 {
-    StringMap::iterator it = _attributeMap.find(attrib);
-    if (it != _attributeMap.end())
+    auto it = std::find_if(_attributes.begin(), _attributes.end(),
+                           [&attrib](const Attribute& attr) { return *attr.first == attrib; });
+    if (it != _attributes.end())
     {
         DocumentPtr doc = getDocument();
 
@@ -251,9 +355,7 @@ void Element::removeAttribute(const string& attrib)
         ScopedUpdate update(doc);
         doc->onRemoveAttribute(getSelf(), attrib);
 
-        _attributeMap.erase(it);
-        _attributeOrder.erase(
-            std::find(_attributeOrder.begin(), _attributeOrder.end(), attrib));
+        _attributes.erase(it);
     }
 }
 
@@ -358,6 +460,12 @@ bool Element::hasInheritanceCycle() const
 
 TreeIterator Element::traverseTree() const
 {
+    // Deferred elements are loaded before a document is traversed.
+    ConstDocumentPtr doc = getDocument();
+    if (doc.get() == this)
+    {
+        doc->loadDeferredElements();
+    }
     return TreeIterator(getSelfNonConst());
 }
 
@@ -391,8 +499,7 @@ void Element::copyContentFrom(const ConstElementPtr& source, const CopyOptions*
     doc->onCopyContent(getSelf());
 
     _sourceUri = source->_sourceUri;
-    _attributeMap = source->_attributeMap;
-    _attributeOrder = source->_attributeOrder;
+    _attributes = source->_attributes;
 
     for (const ConstElementPtr& child : source->getChildren())
     {
@@ -426,8 +533,7 @@ void Element::clearContent()
     doc->onClearContent(getSelf());
 
     _sourceUri = EMPTY_STRING;
-    _attributeMap.clear();
-    _attributeOrder.clear();
+    _attributes.clear();
 
     vector<ElementPtr> children = getChildren();
     for (ElementPtr child : children)
@@ -437,6 +543,11 @@ void Element::clearContent()
 }
 
 bool Element::validate(string* message) const
+{
+    return validateElement(message, 1);
+}
+
+bool Element::validateElement(string* message, unsigned int threadCount) const
 {
     bool res = true;
     validateRequire(isValidName(getName()), res, message, "Invalid element name");
@@ -445,9 +556,30 @@ bool Element::validate(string* message) const
         bool validInherit = getInheritsFrom() && getInheritsFrom()->getCategory() == getCategory();
         validateRequire(validInherit, res, message, "Invalid element inheritance");
     }
-    for (ElementPtr child : getChildren())
+    const vector<ElementPtr>& children = getChildren();
+    if (getWorkerThreadCount(threadCount, children.size()) == 1)
     {
-        res = child->validate(message) && res;
+        for (ElementPtr child : children)
+        {
+            res = child->validate(message) && res;
+        }
+    }
+    else
+    {
+        vector<char> results(children.size(), 0);
+        vector<string> messages(message ? children.size() : 0);
+        runParallelTasks(children.size(), threadCount, [&](size_t index, unsigned int)
+        {
+            results[index] = children[index]->validate(message ? &messages[index] : nullptr);
+        });
+        for (size_t i = 0; i < children.size(); i++)
+        {
+            res = results[i] && res;
+            if (message)
+            {
+                *message += messages[i];
+            }
+        }
     }
     validateRequire(!hasInheritanceCycle(), res, message, "Cycle in element inheritance chain");
     return res;
@@ -513,6 +645,41 @@ string Element::asString() const
     return res;
 }
 
+ElementPtr Element::getDataLibraryChild(const string& name) const
+{
+    ConstDocumentPtr doc = getDocument();
+    ConstDocumentPtr library = doc ? doc->getDataLibrary() : nullptr;
+    if (!library)
+    {
+        return nullptr;
+    }
+
+    // Library elements are stored by their unqualified names, with the
+    // namespace of the library applied at its root.
+    library->loadDeferredElement(name);
+    ElementPtr child = library->getChild(name);
+    if (!child && library->hasNamespace())
+    {
+        const string prefix = library->getNamespace() + NAME_PREFIX_SEPARATOR;
+        if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0)
+        {
+            library->loadDeferredElement(name.substr(prefix.size()));
+            child = library->getChild(name.substr(prefix.size()));
+        }
+    }
+    return child ? child : library->getDataLibraryChild(name);
+}
+
+void Element::loadDeferredRootElement(const string& name) const
+{
+    ConstDocumentPtr doc = getDocument();
+    if (doc && doc->getDeferredElementCount())
+    {
+        doc->loadDeferredElement(getQualifiedName(name));
+        doc->loadDeferredElement(name);
+    }
+}
+
 void Element::validateRequire(bool expression, bool& res, string* message, string errorDesc) const
 {
     if (!expression)
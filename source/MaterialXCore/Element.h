@@ -65,8 +65,10 @@ class Element : public std::enable_shared_from_this<Element>
 {
   protected:
     Element(ElementPtr parent, const string& category, const string& name) :
-        _category(category),
+        _category(&internString(category)),
         _name(name),
+        _removedChildCount(0),
+        _childIndex(0),
         _parent(parent),
         _root(parent ? parent->getRoot() : nullptr)
     {
@@ -82,6 +84,7 @@ class Element : public std::enable_shared_from_this<Element>
     using ConstMaterialPtr = shared_ptr<const Material>;
 
     template <class T> friend class ElementRegistry;
+    friend class Document;
 
   public:
     /// Return true if the given element tree, including all descendants,
@@ -98,7 +101,7 @@ class Element : public std::enable_shared_from_this<Element>
     /// Set the element's category string.
     void setCategory(const string& category)
     {
-        _category = category;
+        _category = &internString(category);
     }
 
     /// Return the element's category string.  The category of a MaterialX
@@ -106,7 +109,7 @@ class Element : public std::enable_shared_from_this<Element>
     /// being "material", "nodegraph", and "image".
     const string& getCategory() const
     {
-        return _category;
+        return *_category;
     }
 
     /// @}
@@ -419,11 +422,9 @@ class Element : public std::enable_shared_from_this<Element>
     /// matches are required.
     template<class T> bool isA(const string& category = EMPTY_STRING) const
     {
-        if (!asA<T>())
-            return false;
         if (!category.empty() && getCategory() != category)
             return false;
-        return true;
+        return dynamic_cast<const T*>(this) != nullptr;
     }
 
     /// Dynamic cast to an instance of the given subclass.
@@ -481,6 +482,10 @@ class Element : public std::enable_shared_from_this<Element>
     /// The returned vector maintains the order in which children were added.
     const vector<ElementPtr>& getChildren() const
     {
+        if (_removedChildCount)
+        {
+            updateChildOrder();
+        }
         return _childOrder;
     }
 
@@ -490,13 +495,22 @@ class Element : public std::enable_shared_from_this<Element>
     template<class T> vector< shared_ptr<T> > getChildrenOfType(const string& category = EMPTY_STRING) const
     {
         vector< shared_ptr<T> > children;
-        for (ElementPtr child : _childOrder)
+        const string* internedCategory = nullptr;
+        if (!category.empty())
         {
+            // Categories are interned, so they may be compared by address,
+            // and no child can match a category that was never interned.
+            internedCategory = findInternedString(category);
+            if (!internedCategory)
+                return children;
+        }
+        for (const ElementPtr& child : getChildren())
+        {
+            if (internedCategory && child->_category != internedCategory)
+                continue;
             shared_ptr<T> instance = child->asA<T>();
             if (!instance)
                 continue;
-            if (!category.empty() && child->getCategory() != category)
-                continue;
             children.push_back(instance);
         }
         return children;
@@ -526,27 +540,36 @@ class Element : public std::enable_shared_from_this<Element>
     /// @name Attributes
     /// @{
 
-    /// Set the value string of the given attribute.
+    /// Set the value string of the given attribute.  Attribute names are
+    /// interned, and interned strings are never freed, so each distinct
+    /// attribute name remains in the global string table for the lifetime
+    /// of the process.
     void setAttribute(const string& attrib, const string& value);
 
     /// Return true if the given attribute is present.
     bool hasAttribute(const string& attrib) const
     {
-        return _attributeMap.count(attrib) != 0;
+        return findAttribute(attrib) != nullptr;
     }
 
     /// Return the value string of the given attribute.  If the given attribute
     /// is not present, then an empty string is returned.
     const string& getAttribute(const string& attrib) const
     {
-        StringMap::const_iterator it = _attributeMap.find(attrib);
-        return (it != _attributeMap.end()) ? it->second : EMPTY_STRING;
+        const string* value = findAttribute(attrib);
+        return value ? *value : EMPTY_STRING;
     }
 
     /// Return a vector of stored attribute names, in the order they were set.
-    const StringVec& getAttributeNames() const
+    StringVec getAttributeNames() const
     {
-        return _attributeOrder;
+        StringVec names;
+        names.reserve(_attributes.size());
+        for (const Attribute& attr : _attributes)
+        {
+            names.push_back(*attr.first);
+        }
+        return names;
     }
 
     /// Set the value of an implicitly typed attribute.  Since an attribute
@@ -833,18 +856,46 @@ class Element : public std::enable_shared_from_this<Element>
 
   protected:
     // Resolve a reference to a named element at the root scope of this document,
-    // taking the namespace at the scope of this element into account.
+    // taking the namespace at the scope of this element and the data library
+    // referenced by the document into account.
     template<class T> shared_ptr<T> resolveRootNameReference(const string& name) const
     {
+        loadDeferredRootElement(name);
         ConstElementPtr root = getRoot();
         shared_ptr<T> child = root->getChildOfType<T>(getQualifiedName(name));
-        return child ? child : root->getChildOfType<T>(name);
+        if (!child)
+        {
+            child = root->getChildOfType<T>(name);
+        }
+        if (!child)
+        {
+            ElementPtr libraryChild = getDataLibraryChild(getQualifiedName(name));
+            if (!libraryChild || !libraryChild->asA<T>())
+            {
+                libraryChild = getDataLibraryChild(name);
+            }
+            child = libraryChild ? libraryChild->asA<T>() : nullptr;
+        }
+        return child;
     }
 
+    // Return the child, if any, with the given name within the data library
+    // referenced by the root document of this element.
+    ElementPtr getDataLibraryChild(const string& name) const;
+
+    // Load any deferred element of the root document that may be resolved
+    // by a reference to the given name.
+    void loadDeferredRootElement(const string& name) const;
+
     // Enforce a requirement within a validate method, updating the validation
     // state and optional output text if the requirement is not met.
     void validateRequire(bool expression, bool& res, string* message, string errorDesc) const;
 
+    // Perform the validation of Element::validate, validating the children of
+    // this element on the given number of worker threads, with messages
+    // merged in child order.
+    bool validateElement(string* message, unsigned int threadCount) const;
+
   public:
     static const string NAME_ATTRIBUTE;
     static const string FILE_PREFIX_ATTRIBUTE;
@@ -861,6 +912,25 @@ class Element : public std::enable_shared_from_this<Element>
     virtual void registerChildElement(ElementPtr child);
     virtual void unregisterChildElement(ElementPtr child);
 
+    // Remove the empty slots left in the child order by removed children.
+    void updateChildOrder() const;
+
+    // Return the index of the given child within the child order, using its
+    // stored index when it is current.
+    size_t findChildIndex(const Element* child) const;
+
+    // Return a pointer to the value string of the given attribute, or nullptr
+    // if the attribute is not present.
+    const string* findAttribute(const string& attrib) const
+    {
+        for (const Attribute& attr : _attributes)
+        {
+            if (*attr.first == attrib)
+                return &attr.second;
+        }
+        return nullptr;
+    }
+
     // Return a non-const copy of our self pointer, for use in constructing
     // graph traversal objects that require non-const storage.
     ElementPtr getSelfNonConst() const
@@ -869,15 +939,28 @@ class Element : public std::enable_shared_from_this<Element>
     }
 
   protected:
-    string _category;
+    const string* _category;
     string _name;
     string _sourceUri;
 
+    // Each child stores its own index within the child order of its parent,
+    // which is checked before use and may be stale after removals.  Children
+    // removed within an enclosing ScopedUpdate leave empty slots in the child
+    // order, which are removed by updateChildOrder at the end of the outermost
+    // update scope, so that a batch of removals runs in amortized constant
+    // time per removal.  Empty slots are only present while the document is
+    // being edited, so const accessors never modify a document that is shared
+    // between readers.
     ElementMap _childMap;
-    vector<ElementPtr> _childOrder;
-
-    StringMap _attributeMap;
-    StringVec _attributeOrder;
+    mutable vector<ElementPtr> _childOrder;
+    mutable size_t _removedChildCount;
+    size_t _childIndex;
+
+    // Attributes are stored as pairs of interned names and value strings, in
+    // the order they were set.  Since most elements hold only a handful of
+    // attributes, a linear scan outperforms a per-element hash map.
+    using Attribute = std::pair<const string*, string>;
+    vector<Attribute> _attributes;
 
     weak_ptr<Element> _parent;
     weak_ptr<Element> _root;
@@ -278,146 +278,177 @@ bool Output::validate(string* message) const
 // InterfaceElement methods
 //
 
-ParameterPtr InterfaceElement::getActiveParameter(const string& name) const
+class InterfaceElement::ResolvedInterface
 {
-    for (ConstElementPtr elem : traverseInheritance())
+  public:
+    ResolvedInterface(uint64_t docRevision) :
+        revision(docRevision)
     {
-        ParameterPtr param = elem->asA<InterfaceElement>()->getParameter(name);
-        if (param)
+    }
+
+    // Append the children of the given interface to the active element
+    // vectors, skipping those whose names are hidden by derived interfaces.
+    void addInterface(const InterfaceElement& interface)
+    {
+        for (const ElementPtr& child : interface.getChildren())
         {
-            return param;
+            ValueElementPtr valueElem = child->asA<ValueElement>();
+            if (!valueElem)
+            {
+                continue;
+            }
+            const string& name = valueElem->getName();
+            bool active = valueElemNames.insert(name).second;
+            if (active)
+            {
+                valueElements.push_back(valueElem);
+            }
+            if (valueElem->isA<Parameter>())
+            {
+                parameters.push_back(valueElem->asA<Parameter>());
+            }
+            else if (valueElem->isA<Input>())
+            {
+                if (inputNames.insert(name).second)
+                {
+                    inputs.push_back(valueElem->asA<Input>());
+                }
+            }
+            else if (valueElem->isA<Output>())
+            {
+                if (outputNames.insert(name).second)
+                {
+                    outputs.push_back(valueElem->asA<Output>());
+                }
+            }
+            else if (valueElem->isA<Token>())
+            {
+                tokens.push_back(valueElem->asA<Token>());
+            }
         }
     }
-    return nullptr;
-}
 
-vector<ParameterPtr> InterfaceElement::getActiveParameters() const
+  public:
+    const uint64_t revision;
+    vector<ConstInterfaceElementPtr> bases;
+    vector<ParameterPtr> parameters;
+    vector<InputPtr> inputs;
+    vector<OutputPtr> outputs;
+    vector<TokenPtr> tokens;
+    vector<ValueElementPtr> valueElements;
+
+  private:
+    StringSet valueElemNames;
+    StringSet inputNames;
+    StringSet outputNames;
+};
+
+const InterfaceElement::ResolvedInterface& InterfaceElement::getResolvedInterface() const
 {
-    vector<ParameterPtr> activeParams;
-    for (ConstElementPtr elem : traverseInheritance())
+    // Orphaned elements, whose documents no longer exist, can no longer be
+    // edited, and are assigned a fixed revision of zero.
+    ElementPtr root = _root.lock();
+    ConstDocumentPtr doc = root ? root->asA<Document>() : nullptr;
+    uint64_t revision = doc ? doc->getRevision() : 0;
+
+    shared_ptr<const ResolvedInterface> resolved = std::atomic_load(&_resolvedInterface);
+    if (resolved && resolved->revision == revision)
     {
-        vector<ParameterPtr> params = elem->asA<InterfaceElement>()->getParameters();
-        activeParams.insert(activeParams.end(), params.begin(), params.end());
+        return *resolved;
     }
-    return activeParams;
-}
 
-InputPtr InterfaceElement::getActiveInput(const string& name) const
-{
+    shared_ptr<ResolvedInterface> newResolved = std::make_shared<ResolvedInterface>(revision);
     for (ConstElementPtr elem : traverseInheritance())
     {
-        InputPtr input = elem->asA<InterfaceElement>()->getInput(name);
-        if (input)
+        ConstInterfaceElementPtr interface = elem->asA<InterfaceElement>();
+        if (interface.get() != this)
         {
-            return input;
+            newResolved->bases.push_back(interface);
         }
+        newResolved->addInterface(*interface);
     }
-    return nullptr;
-}
 
-vector<InputPtr> InterfaceElement::getActiveInputs() const
-{
-    vector<InputPtr> activeInputs;
-    StringSet activeInputNamesSet;
-    for (ConstElementPtr elem : traverseInheritance())
+    // Publish the new resolution, deferring to any equivalent resolution
+    // published concurrently by another reader, as references to it may
+    // already have been returned.
+    shared_ptr<const ResolvedInterface> desired = newResolved;
+    while (!std::atomic_compare_exchange_weak(&_resolvedInterface, &resolved, desired))
     {
-        vector<InputPtr> inputs = elem->asA<InterfaceElement>()->getInputs();
-        for (const InputPtr& input : inputs)
+        if (resolved && resolved->revision == revision)
         {
-            if (input && activeInputNamesSet.insert(input->getName()).second)
-            {
-                activeInputs.push_back(input);
-            }
+            return *resolved;
         }
     }
-    return activeInputs;
+    return *desired;
 }
 
-OutputPtr InterfaceElement::getActiveOutput(const string& name) const
+template<class T> shared_ptr<T> InterfaceElement::getActiveChildOfType(const string& name) const
 {
-    for (ConstElementPtr elem : traverseInheritance())
+    shared_ptr<T> child = getChildOfType<T>(name);
+    if (child || !hasInheritString())
     {
-        OutputPtr output = elem->asA<InterfaceElement>()->getOutput(name);
-        if (output)
+        return child;
+    }
+    for (const ConstInterfaceElementPtr& base : getResolvedInterface().bases)
+    {
+        child = base->getChildOfType<T>(name);
+        if (child)
         {
-            return output;
+            return child;
         }
     }
     return nullptr;
 }
 
 
+ParameterPtr InterfaceElement::getActiveParameter(const string& name) const
+{
+    return getActiveChildOfType<Parameter>(name);
+}
+
+vector<ParameterPtr> InterfaceElement::getActiveParameters() const
+{
+    return getResolvedInterface().parameters;
+}
+
+InputPtr InterfaceElement::getActiveInput(const string& name) const
+{
+    return getActiveChildOfType<Input>(name);
+}
+
+vector<InputPtr> InterfaceElement::getActiveInputs() const
+{
+    return getResolvedInterface().inputs;
+}
+
+OutputPtr InterfaceElement::getActiveOutput(const string& name) const
+{
+    return getActiveChildOfType<Output>(name);
+}
+
 vector<OutputPtr> InterfaceElement::getActiveOutputs() const
 {
-    vector<OutputPtr> activeOutputs;
-    StringSet activeOutputNamesSet;
-    for (ConstElementPtr elem : traverseInheritance())
-    {
-        vector<OutputPtr> outputs = elem->asA<InterfaceElement>()->getOutputs();
-        for (const OutputPtr& output : outputs)
-        {
-            if (output && activeOutputNamesSet.insert(output->getName()).second)
-            {
-                activeOutputs.push_back(output);
-            }
-        }
-    }
-    return activeOutputs;
+    return getResolvedInterface().outputs;
 }
 
 TokenPtr InterfaceElement::getActiveToken(const string& name) const
 {
-    for (ConstElementPtr elem : traverseInheritance())
-    {
-        TokenPtr token = elem->asA<InterfaceElement>()->getToken(name);
-        if (token)
-        {
-            return token;
-        }
-    }
-    return nullptr;
+    return getActiveChildOfType<Token>(name);
 }
 
 vector<TokenPtr> InterfaceElement::getActiveTokens() const
 {
-    vector<TokenPtr> activeTokens;
-    for (ConstElementPtr elem : traverseInheritance())
-    {
-        vector<TokenPtr> tokens = elem->asA<InterfaceElement>()->getTokens();
-        activeTokens.insert(activeTokens.end(), tokens.begin(), tokens.end());
-    }
-    return activeTokens;
+    return getResolvedInterface().tokens;
 }
 
 ValueElementPtr InterfaceElement::getActiveValueElement(const string& name) const
 {
-    for (ConstElementPtr interface : traverseInheritance())
-    {
-        ValueElementPtr valueElem = interface->getChildOfType<ValueElement>(name);
-        if (valueElem)
-        {
-            return valueElem;
-        }
-    }
-    return nullptr;
+    return getActiveChildOfType<ValueElement>(name);
 }
 
 vector<ValueElementPtr> InterfaceElement::getActiveValueElements() const
 {
-    vector<ValueElementPtr> activeValueElems;
-    StringSet activeValueElemNamesSet;
-    for (ConstElementPtr interface : traverseInheritance())
-    {
-        vector<ValueElementPtr> valueElems = interface->getChildrenOfType<ValueElement>();
-        for (const ValueElementPtr& valueElem : valueElems)
-        {
-            if (valueElem && activeValueElemNamesSet.insert(valueElem->getName()).second)
-            {
-                activeValueElems.push_back(valueElem);
-            }
-        }
-    }
-    return activeValueElems;
+    return getResolvedInterface().valueElements;
 }
 
 ValuePtr InterfaceElement::getParameterValue(const string& name, const string& target) const
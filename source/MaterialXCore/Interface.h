@@ -329,6 +329,11 @@ class Output : public PortElement
 ///
 /// An InterfaceElement supports a set of Parameter, Input, and Output elements,
 /// with an API for setting their values.
+///
+/// The active elements of an interface, which take interface inheritance into
+/// account, are resolved on first request and cached until the document or
+/// its data library is next edited, so that repeated queries perform no
+/// traversal.
 class InterfaceElement : public TypedElement
 {
   protected:
@@ -664,10 +669,22 @@ class InterfaceElement : public TypedElement
     void registerChildElement(ElementPtr child) override;
     void unregisterChildElement(ElementPtr child) override;
 
+  private:
+    class ResolvedInterface;
+
+    // Return the active elements of this interface, resolving them if the
+    // cached resolution is missing or stale.
+    const ResolvedInterface& getResolvedInterface() const;
+
+    // Return the first child with the given name and subclass in this
+    // interface or its inherited bases.
+    template<class T> shared_ptr<T> getActiveChildOfType(const string& name) const;
+
   private:
     size_t _parameterCount;
     size_t _inputCount;
     size_t _outputCount;
+    mutable shared_ptr<const ResolvedInterface> _resolvedInterface;
 };
 
 template<class T> ParameterPtr InterfaceElement::setParameterValue(const string& name,
@@ -50,6 +50,9 @@ class Observer
     /// Called when an attribute of an element is removed.
     virtual void onRemoveAttribute(ElementPtr, const string&) { }
 
+    /// Called when the children of an element are reordered.
+    virtual void onSetChildOrder(ElementPtr) { }
+
     /// Called when content is copied into an element.
     virtual void onCopyContent(ElementPtr) { }
 
@@ -139,8 +142,10 @@ class ObservedDocument : public Document
 
     DocumentPtr copy() const override
     {
-        DocumentPtr doc = createDocument<ObservedDocument>();
+        ObservedDocumentPtr doc = createDocument<ObservedDocument>();
         doc->copyContentFrom(getSelf());
+        doc->setDataLibrary(getDataLibrary());
+        doc->copyDeferredElements(*this);
         return doc;
     }
 
@@ -193,8 +198,21 @@ class ObservedDocument : public Document
         }
     }
 
+    void onSetChildOrder(ElementPtr elem) override
+    {
+        Document::onSetChildOrder(elem);
+        if (_callbacksEnabled)
+        {
+            for (auto& item : _observerMap)
+            {
+                item.second->onSetChildOrder(elem);
+            }
+        }
+    }
+
     void onCopyContent(ElementPtr elem) override
     {
+        Document::onCopyContent(elem);
         if (_callbacksEnabled)
         {
             for (auto& item : _observerMap)
@@ -206,6 +224,7 @@ class ObservedDocument : public Document
 
     void onClearContent(ElementPtr elem) override
     {
+        Document::onClearContent(elem);
         if (_callbacksEnabled)
         {
             for (auto& item : _observerMap)
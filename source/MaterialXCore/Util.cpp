@@ -7,6 +7,11 @@
 
 #include <MaterialXCore/Element.h>
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
 namespace MaterialX
 {
 
@@ -27,6 +32,35 @@ bool invalidNameChar(char c)
      return !isalnum(c) && c != '_' && c != ':';
 }
 
+// The global table of interned strings.  Elements of an unordered_set are
+// never relocated, so their addresses remain stable as the table grows, and
+// the table itself is never destroyed, so that interned strings outlive any
+// static elements that reference them.  The table is split into shards,
+// selected from the length and end characters of each string, with a mutex
+// per shard, so that concurrent lookups of different strings rarely contend
+// for the same lock.
+const size_t INTERN_SHARD_COUNT = 64;
+
+struct InternShard
+{
+    std::mutex mutex;
+    std::unordered_set<string> strings;
+};
+
+InternShard& getInternShard(const string& str)
+{
+    // Shards are selected from the length and end characters of the string,
+    // which is much cheaper than a second full hash of the string.
+    static InternShard* shards = new InternShard[INTERN_SHARD_COUNT];
+    size_t index = str.size();
+    if (!str.empty())
+    {
+        index = index * 31 + (unsigned char) str.front();
+        index = index * 31 + (unsigned char) str.back();
+    }
+    return shards[index % INTERN_SHARD_COUNT];
+}
+
 } // anonymous namespace
 
 //
@@ -108,6 +142,21 @@ string replaceSubstrings(string str, const StringMap& stringMap)
     return str;
 }
 
+const string& internString(const string& str)
+{
+    InternShard& shard = getInternShard(str);
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    return *shard.strings.insert(str).first;
+}
+
+const string* findInternedString(const string& str)
+{
+    InternShard& shard = getInternShard(str);
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    auto it = shard.strings.find(str);
+    return (it != shard.strings.end()) ? &(*it) : nullptr;
+}
+
 string prettyPrint(ConstElementPtr elem)
 {
     string text;
@@ -119,4 +168,77 @@ string prettyPrint(ConstElementPtr elem)
     return text;
 }
 
+unsigned int getWorkerThreadCount(unsigned int threadCount, size_t taskCount)
+{
+    if (!threadCount)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    return (unsigned int) std::min((size_t) threadCount, std::max(taskCount, (size_t) 1));
+}
+
+void runParallelTasks(size_t taskCount, unsigned int threadCount,
+                      const std::function<void(size_t, unsigned int)>& task)
+{
+    threadCount = getWorkerThreadCount(threadCount, taskCount);
+    if (threadCount == 1)
+    {
+        for (size_t i = 0; i < taskCount; i++)
+        {
+            task(i, 0);
+        }
+        return;
+    }
+
+    // Workers claim tasks in index order, storing any exception for each
+    // task so that the earliest may be reported.
+    vector<std::exception_ptr> errors(taskCount);
+    std::atomic<size_t> nextIndex(0);
+    vector<std::thread> workers;
+    workers.reserve(threadCount);
+    try
+    {
+        for (unsigned int i = 0; i < threadCount; i++)
+        {
+            workers.emplace_back([&, i]()
+            {
+                for (size_t index = nextIndex++; index < taskCount; index = nextIndex++)
+                {
+                    try
+                    {
+                        task(index, i);
+                    }
+                    catch (...)
+                    {
+                        errors[index] = std::current_exception();
+                    }
+                }
+            });
+        }
+    }
+    catch (...)
+    {
+        // A worker could not be started, so the remaining tasks are
+        // abandoned, and the workers already started are joined before the
+        // exception is rethrown.
+        nextIndex = taskCount;
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+        throw;
+    }
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    for (const std::exception_ptr& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
 } // namespace MaterialX
@@ -44,10 +44,38 @@ StringVec splitString(const string& str, const string& sep);
 /// Apply the given substring substitutions to the input string.
 string replaceSubstrings(string str, const StringMap& stringMap);
 
+/// Return the interned copy of the given string, adding it to the global
+/// string table if it is not already present.  Interned strings persist for
+/// the lifetime of the process, so the returned reference remains valid
+/// and may be compared by address against other interned strings.
+const string& internString(const string& str);
+
+/// Return a pointer to the interned copy of the given string, or nullptr
+/// if the string has not been interned.
+const string* findInternedString(const string& str);
+
 /// Pretty print the given element tree, calling asString recursively on each
 /// element in depth-first order.
 string prettyPrint(ConstElementPtr elem);
 
+/// Return the number of worker threads used by runParallelTasks for the given
+/// requested thread count and number of tasks.  A requested count of zero
+/// selects the number of hardware threads, and no more threads are used than
+/// there are tasks.
+unsigned int getWorkerThreadCount(unsigned int threadCount, size_t taskCount);
+
+/// Run the given task once for each index from zero to taskCount - 1, on a
+/// pool of worker threads whose size is given by getWorkerThreadCount.  The
+/// task is passed the index of the task, and the index of the worker thread
+/// running it.  When only one worker would be used, the tasks are run in
+/// order on the calling thread, stopping at the first exception.  Otherwise,
+/// the exception, if any, thrown by the task with the lowest index is
+/// rethrown once all tasks have finished.  If a worker thread cannot be
+/// started, the workers already started are joined and the exception is
+/// rethrown.
+void runParallelTasks(size_t taskCount, unsigned int threadCount,
+                      const std::function<void(size_t, unsigned int)>& task);
+
 } // namespace MaterialX
 
 #endif
@@ -7,7 +7,11 @@
 
 #include <MaterialXCore/Util.h>
 
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
+#include <limits>
+#include <locale>
 #include <sstream>
 #include <type_traits>
 
@@ -30,23 +34,272 @@ template <class T> class is_std_vector< vector<T> > : public std::true_type { };
 template <class T> using enable_if_std_vector_t =
     typename std::enable_if<is_std_vector<T>::value, T>::type;
 
-template <class T> void stringToData(const string& str, T& data)
+// Exact powers of ten in double precision.
+const double EXACT_POWERS_OF_TEN[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+const int MAX_EXACT_POWER_OF_TEN = 22;
+const uint64_t MAX_EXACT_MANTISSA = uint64_t(1) << 53;
+const int MAX_MANTISSA_DIGITS = 19;
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+bool isArraySeparator(char c)
+{
+    return ARRAY_VALID_SEPARATORS.find(c) != string::npos;
+}
+
+// Return true if the given double lies exactly halfway between two adjacent
+// single-precision values, in which case rounding it to single precision
+// may differ from rounding the original decimal value.
+bool isFloatMidpoint(double value)
 {
-    std::stringstream ss(str);
-    if (!(ss >> data))
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x1fffffff) == 0x10000000;
+}
+
+// The following functions parse a value from the front of the given
+// character range in the manner of std::from_chars, independent of the
+// current locale, returning a pointer past the last character parsed, or
+// nullptr if no value could be parsed.  Leading whitespace is skipped, to
+// match the behavior of stream extraction.
+
+template <class T> const char* parseInteger(const char* pos, const char* end, T& data)
+{
+    while (pos != end && isSpace(*pos))
+        pos++;
+    bool negative = false;
+    if (pos != end && (*pos == '+' || *pos == '-'))
     {
-        throw ExceptionTypeError("Type mismatch in generic stringToData: " + str);
+        negative = (*pos == '-');
+        pos++;
+    }
+    if (pos == end || !isDigit(*pos))
+    {
+        return nullptr;
     }
+
+    using UnsignedT = typename std::make_unsigned<T>::type;
+    const UnsignedT limit = negative ? UnsignedT(std::numeric_limits<T>::max()) + 1 :
+                                       UnsignedT(std::numeric_limits<T>::max());
+    UnsignedT value = 0;
+    for (; pos != end && isDigit(*pos); pos++)
+    {
+        UnsignedT digit = UnsignedT(*pos - '0');
+        if (value > (limit - digit) / 10)
+        {
+            return nullptr;
+        }
+        value = value * 10 + digit;
+    }
+    data = negative ? T(0 - value) : T(value);
+    return pos;
 }
 
-template <> void stringToData(const string& str, bool& data)
+template <class T> const char* parseFloat(const char* pos, const char* end, T& data)
+{
+    while (pos != end && isSpace(*pos))
+        pos++;
+    const char* begin = pos;
+    bool negative = false;
+    if (pos != end && (*pos == '+' || *pos == '-'))
+    {
+        negative = (*pos == '-');
+        pos++;
+    }
+
+    // Accumulate up to MAX_MANTISSA_DIGITS significant digits.
+    uint64_t mantissa = 0;
+    int mantissaDigits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    bool truncated = false;
+    for (; pos != end && isDigit(*pos); pos++)
+    {
+        hasDigits = true;
+        if (mantissaDigits < MAX_MANTISSA_DIGITS)
+        {
+            mantissa = mantissa * 10 + uint64_t(*pos - '0');
+            mantissaDigits += (mantissa != 0);
+        }
+        else
+        {
+            truncated = true;
+        }
+    }
+    if (pos != end && *pos == '.')
+    {
+        for (pos++; pos != end && isDigit(*pos); pos++)
+        {
+            hasDigits = true;
+            if (mantissaDigits < MAX_MANTISSA_DIGITS)
+            {
+                mantissa = mantissa * 10 + uint64_t(*pos - '0');
+                mantissaDigits += (mantissa != 0);
+                exponent--;
+            }
+            else
+            {
+                truncated = true;
+            }
+        }
+    }
+    if (!hasDigits)
+    {
+        return nullptr;
+    }
+    if (pos != end && (*pos == 'e' || *pos == 'E'))
+    {
+        pos++;
+        bool negativeExponent = false;
+        if (pos != end && (*pos == '+' || *pos == '-'))
+        {
+            negativeExponent = (*pos == '-');
+            pos++;
+        }
+        if (pos == end || !isDigit(*pos))
+        {
+            return nullptr;
+        }
+        int exponentValue = 0;
+        for (; pos != end && isDigit(*pos); pos++)
+        {
+            if (exponentValue < 100000)
+            {
+                exponentValue = exponentValue * 10 + (*pos - '0');
+            }
+        }
+        exponent += negativeExponent ? -exponentValue : exponentValue;
+    }
+
+    // When the mantissa and power of ten are both exact in double precision,
+    // a single multiplication or division yields the correctly rounded result.
+    if (!truncated && mantissa <= MAX_EXACT_MANTISSA &&
+        exponent >= -MAX_EXACT_POWER_OF_TEN && exponent <= MAX_EXACT_POWER_OF_TEN)
+    {
+        double value = (double) mantissa;
+        value = (exponent < 0) ? value / EXACT_POWERS_OF_TEN[-exponent] :
+                                 value * EXACT_POWERS_OF_TEN[exponent];
+        if (!std::is_same<T, float>::value || !isFloatMidpoint(value))
+        {
+            data = T(negative ? -value : value);
+            return pos;
+        }
+    }
+
+    // Otherwise, fall back to stream extraction in the classic locale.
+    std::istringstream stream(string(begin, pos));
+    stream.imbue(std::locale::classic());
+    if (!(stream >> data))
+    {
+        return nullptr;
+    }
+    return pos;
+}
+
+const char* parseValue(const char* pos, const char* end, int& data)
+{
+    return parseInteger(pos, end, data);
+}
+
+const char* parseValue(const char* pos, const char* end, long& data)
 {
-    if (str == VALUE_STRING_TRUE)
+    return parseInteger(pos, end, data);
+}
+
+const char* parseValue(const char* pos, const char* end, float& data)
+{
+    return parseFloat(pos, end, data);
+}
+
+const char* parseValue(const char* pos, const char* end, double& data)
+{
+    return parseFloat(pos, end, data);
+}
+
+const char* parseValue(const char* pos, const char* end, bool& data)
+{
+    size_t size = (size_t) (end - pos);
+    if (size == VALUE_STRING_TRUE.size() && std::equal(pos, end, VALUE_STRING_TRUE.begin()))
         data = true;
-    else if (str == VALUE_STRING_FALSE)
+    else if (size == VALUE_STRING_FALSE.size() && std::equal(pos, end, VALUE_STRING_FALSE.begin()))
         data = false;
     else
+        return nullptr;
+    return end;
+}
+
+const char* parseValue(const char* pos, const char* end, string& data)
+{
+    data.assign(pos, end);
+    return end;
+}
+
+// Find the next token in the given array string, returning false if no
+// tokens remain.
+bool nextArrayToken(const char*& pos, const char* end, const char*& tokenEnd)
+{
+    while (pos != end && isArraySeparator(*pos))
+        pos++;
+    if (pos == end)
+    {
+        return false;
+    }
+    tokenEnd = pos;
+    while (tokenEnd != end && !isArraySeparator(*tokenEnd))
+        tokenEnd++;
+    return true;
+}
+
+// Parse the tokens of the given array string into the given sequence of
+// values, returning the number of tokens found, or a count greater than
+// the size of the sequence if there are too many tokens.
+template <class T> size_t parseArrayTokens(const string& str, T* data, size_t size, const char* typeName)
+{
+    const char* pos = str.data();
+    const char* end = pos + str.size();
+    const char* tokenEnd;
+    size_t count = 0;
+    while (nextArrayToken(pos, end, tokenEnd))
+    {
+        if (count == size)
+        {
+            return size + 1;
+        }
+        if (!parseValue(pos, tokenEnd, data[count++]))
+        {
+            throw ExceptionTypeError(string("Type mismatch in ") + typeName + " stringToData: " + str);
+        }
+        pos = tokenEnd;
+    }
+    return count;
+}
+
+template <class T> void stringToData(const string& str, T& data)
+{
+    if (!parseValue(str.data(), str.data() + str.size(), data))
+    {
+        throw ExceptionTypeError("Type mismatch in generic stringToData: " + str);
+    }
+}
+
+template <> void stringToData(const string& str, bool& data)
+{
+    if (!parseValue(str.data(), str.data() + str.size(), data))
+    {
         throw ExceptionTypeError("Type mismatch in boolean stringToData: " + str);
+    }
 }
 
 template <> void stringToData(const string& str, string& data)
@@ -56,40 +309,35 @@ template <> void stringToData(const string& str, string& data)
 
 template <class T> void stringToData(const string& str, enable_if_mx_vector_t<T>& data)
 {
-    StringVec tokens = splitString(str, ARRAY_VALID_SEPARATORS);
-    if (tokens.size() != data.numElements())
+    if (parseArrayTokens(str, data.data(), data.numElements(), "vector") != data.numElements())
     {
         throw ExceptionTypeError("Type mismatch in vector stringToData: " + str);
     }
-    for (size_t i = 0; i < data.numElements(); i++)
-    {
-        stringToData(tokens[i], data[i]);
-    }
 }
 
 template <class T> void stringToData(const string& str, enable_if_mx_matrix_t<T>& data)
 {
-    StringVec tokens = splitString(str, ARRAY_VALID_SEPARATORS);
-    if (tokens.size() != data.numRows() * data.numColumns())
+    size_t size = data.numRows() * data.numColumns();
+    if (parseArrayTokens(str, &data[0][0], size, "matrix") != size)
     {
         throw ExceptionTypeError("Type mismatch in matrix stringToData: " + str);
     }
-    for (size_t i = 0; i < data.numRows(); i++)
-    {
-        for (size_t j = 0; j < data.numColumns(); j++)
-        {
-            stringToData(tokens[i * data.numRows() + j], data[i][j]);
-        }
-    }
 }
 
 template <class T> void stringToData(const string& str, enable_if_std_vector_t<T>& data)
 {
-    for (const string& token : splitString(str, ARRAY_VALID_SEPARATORS))
+    const char* pos = str.data();
+    const char* end = pos + str.size();
+    const char* tokenEnd;
+    while (nextArrayToken(pos, end, tokenEnd))
     {
         typename T::value_type val;
-        stringToData(token, val);
+        if (!parseValue(pos, tokenEnd, val))
+        {
+            throw ExceptionTypeError("Type mismatch in array stringToData: " + str);
+        }
         data.push_back(val);
+        pos = tokenEnd;
     }
 }
 
@@ -190,6 +438,11 @@ template <class T> T fromValueString(const string& value)
     return data;
 }
 
+void parseFloatArray(const string& str, FloatVec& data)
+{
+    stringToData<FloatVec>(str, data);
+}
+
 //
 // TypedValue methods
 //
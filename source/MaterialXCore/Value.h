@@ -214,9 +214,20 @@ template<class T> const string& getTypeString();
 template <class T> string toValueString(const T& data);
 
 /// Convert the given value string to a data value of the given type.
+/// Numeric values are parsed independently of the current locale.
 /// @throws ExceptionTypeError if the conversion cannot be performed.
 template <class T> T fromValueString(const string& value);
 
+/// Parse a string of float values separated by commas or spaces, such as the
+/// value string of a floatarray, appending the parsed values to the given
+/// vector.  Parsing is independent of the current locale, and in the common
+/// case performs no allocations beyond the growth of the given vector, so
+/// that a single vector may be reused across many calls.  Tokens that
+/// cannot be converted exactly, such as those with many significant digits
+/// or large exponents, fall back to stream extraction, which allocates.
+/// @throws ExceptionTypeError if a token cannot be parsed as a float.
+void parseFloatArray(const string& str, FloatVec& data);
+
 } // namespace MaterialX
 
 #endif
@@ -0,0 +1,288 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXFormat/BinaryIo.h>
+
+#include <MaterialXFormat/Environ.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace MaterialX
+{
+
+const string MTLXB_EXTENSION = "mtlxb";
+const unsigned int BINARY_FORMAT_VERSION = 1;
+
+namespace {
+
+const char BINARY_SIGNATURE[] = "MTLXB\r\n\x1a";
+const size_t BINARY_SIGNATURE_SIZE = sizeof(BINARY_SIGNATURE) - 1;
+const size_t MAX_ELEMENT_DEPTH = 256;
+
+//
+// Writing
+//
+
+class BinaryWriter
+{
+  public:
+    void writeElement(ConstElementPtr elem)
+    {
+        writeString(_records, elem->getCategory());
+        writeString(_records, elem->getName());
+        writeString(_records, elem->getSourceUri());
+
+        StringVec attrNames = elem->getAttributeNames();
+        writeInteger(_records, attrNames.size());
+        for (const string& attrName : attrNames)
+        {
+            writeString(_records, attrName);
+            writeString(_records, elem->getAttribute(attrName));
+        }
+
+        const vector<ElementPtr>& children = elem->getChildren();
+        writeInteger(_records, children.size());
+        for (const ElementPtr& child : children)
+        {
+            writeElement(child);
+        }
+    }
+
+    void save(std::ostream& stream)
+    {
+        string header(BINARY_SIGNATURE, BINARY_SIGNATURE_SIZE);
+        writeInteger(header, BINARY_FORMAT_VERSION);
+        writeInteger(header, _strings.size());
+        stream.write(header.data(), (std::streamsize) header.size());
+        stream.write(_stringTable.data(), (std::streamsize) _stringTable.size());
+        stream.write(_records.data(), (std::streamsize) _records.size());
+    }
+
+  private:
+    // Append the string table index of the given string to the given buffer,
+    // adding the string to the table if needed.
+    void writeString(string& buffer, const string& str)
+    {
+        auto it = _strings.find(str);
+        if (it == _strings.end())
+        {
+            it = _strings.emplace(str, _strings.size()).first;
+            writeInteger(_stringTable, str.size());
+            _stringTable += str;
+        }
+        writeInteger(buffer, it->second);
+    }
+
+    static void writeInteger(string& buffer, size_t value)
+    {
+        while (value >= 0x80)
+        {
+            buffer += (char) ((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        buffer += (char) value;
+    }
+
+  private:
+    std::unordered_map<string, size_t> _strings;
+    string _stringTable;
+    string _records;
+};
+
+//
+// Reading
+//
+
+class BinaryReader
+{
+  public:
+    BinaryReader(const char* data, size_t size) :
+        _pos(data),
+        _end(data + size)
+    {
+    }
+
+    void readDocument(DocumentPtr doc)
+    {
+        if ((size_t) (_end - _pos) < BINARY_SIGNATURE_SIZE ||
+            std::memcmp(_pos, BINARY_SIGNATURE, BINARY_SIGNATURE_SIZE))
+        {
+            throw ExceptionParseError("Invalid signature in binary document");
+        }
+        _pos += BINARY_SIGNATURE_SIZE;
+
+        size_t version = readInteger();
+        if (version != BINARY_FORMAT_VERSION)
+        {
+            throw ExceptionParseError("Unsupported binary document version: " + std::to_string(version));
+        }
+
+        size_t stringCount = readInteger();
+        _strings.reserve(std::min(stringCount, (size_t) (_end - _pos)));
+        for (size_t i = 0; i < stringCount; i++)
+        {
+            size_t length = readInteger();
+            if ((size_t) (_end - _pos) < length)
+            {
+                throw ExceptionParseError("Unexpected end of binary document");
+            }
+            _strings.emplace_back(_pos, length);
+            _pos += length;
+        }
+
+        // The name of the document itself is not read, matching the behavior
+        // of XML documents.
+        readString();
+        readString();
+        readElement(doc, 0);
+        if (_pos != _end)
+        {
+            throw ExceptionParseError("Unexpected data at end of binary document");
+        }
+    }
+
+  private:
+    // Read the source URI, attributes, and children of the given element.
+    void readElement(ElementPtr elem, size_t depth)
+    {
+        if (depth > MAX_ELEMENT_DEPTH)
+        {
+            throw ExceptionParseError("Maximum element depth exceeded in binary document");
+        }
+
+        const string& sourceUri = readString();
+        if (!sourceUri.empty())
+        {
+            elem->setSourceUri(sourceUri);
+        }
+
+        size_t attrCount = readInteger();
+        for (size_t i = 0; i < attrCount; i++)
+        {
+            const string& attrName = readString();
+            const string& attrValue = readString();
+            elem->setAttribute(attrName, attrValue);
+        }
+
+        size_t childCount = readInteger();
+        for (size_t i = 0; i < childCount; i++)
+        {
+            const string& category = readString();
+            const string& name = readString();
+            if (elem->getChild(name))
+            {
+                throw ExceptionParseError("Duplicate element name in binary document: " + name);
+            }
+            ElementPtr child = elem->addChildOfCategory(category, name);
+            readElement(child, depth + 1);
+        }
+    }
+
+    const string& readString()
+    {
+        size_t index = readInteger();
+        if (index >= _strings.size())
+        {
+            throw ExceptionParseError("Invalid string index in binary document");
+        }
+        return _strings[index];
+    }
+
+    size_t readInteger()
+    {
+        size_t value = 0;
+        for (unsigned int shift = 0; shift < sizeof(size_t) * 8; shift += 7)
+        {
+            if (_pos == _end)
+            {
+                throw ExceptionParseError("Unexpected end of binary document");
+            }
+            unsigned char byte = (unsigned char) *_pos++;
+            value |= (size_t) (byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+            {
+                return value;
+            }
+        }
+        throw ExceptionParseError("Invalid integer in binary document");
+    }
+
+  private:
+    const char* _pos;
+    const char* _end;
+    StringVec _strings;
+};
+
+void documentFromBinary(DocumentPtr doc, const string& data)
+{
+    ScopedUpdate update(doc);
+    doc->onRead();
+
+    BinaryReader reader(data.data(), data.size());
+    reader.readDocument(doc);
+
+    doc->upgradeVersion();
+}
+
+} // anonymous namespace
+
+//
+// Reading
+//
+
+void readFromBinaryStream(DocumentPtr doc, std::istream& stream)
+{
+    std::ostringstream buffer;
+    buffer << stream.rdbuf();
+    documentFromBinary(doc, buffer.str());
+}
+
+void readFromBinaryFile(DocumentPtr doc, const FilePath& filename, const FileSearchPath& searchPath)
+{
+    FileSearchPath fullSearchPath = searchPath;
+    fullSearchPath.append(getEnvironmentPath());
+    FilePath resolvedFilename = fullSearchPath.find(filename);
+
+    std::ifstream ifs(resolvedFilename.asString(), std::ios::binary | std::ios::ate);
+    if (!ifs)
+    {
+        throw ExceptionFileMissing("Failed to open file for reading: " + resolvedFilename.asString());
+    }
+    string data((size_t) ifs.tellg(), '\0');
+    ifs.seekg(0);
+    ifs.read(&data[0], (std::streamsize) data.size());
+    if (!ifs)
+    {
+        throw ExceptionFileMissing("Failed to read file: " + resolvedFilename.asString());
+    }
+    documentFromBinary(doc, data);
+}
+
+//
+// Writing
+//
+
+void writeToBinaryStream(DocumentPtr doc, std::ostream& stream)
+{
+    ScopedUpdate update(doc);
+    doc->onWrite();
+    doc->loadDeferredElements();
+
+    BinaryWriter writer;
+    writer.writeElement(doc);
+    writer.save(stream);
+}
+
+void writeToBinaryFile(DocumentPtr doc, const FilePath& filename)
+{
+    std::ofstream ofs(filename.asString(), std::ios::binary);
+    writeToBinaryStream(doc, ofs);
+}
+
+} // namespace MaterialX
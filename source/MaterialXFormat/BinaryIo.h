@@ -0,0 +1,78 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef MATERIALX_BINARYIO_H
+#define MATERIALX_BINARYIO_H
+
+/// @file
+/// Support for the MTLXB binary file format
+///
+/// A binary document begins with an eight-byte signature and a format version,
+/// followed by a table of the distinct strings in the document and a tree of
+/// element records, each of which refers to its category, name, source URI,
+/// and attributes by their indices in the string table.  All integers are
+/// stored as little-endian base-128 varints.
+
+#include <MaterialXCore/Library.h>
+
+#include <MaterialXCore/Document.h>
+
+#include <MaterialXFormat/XmlIo.h>
+
+namespace MaterialX
+{
+
+extern const string MTLXB_EXTENSION;
+
+/// The version of the binary format written by writeToBinaryStream.
+extern const unsigned int BINARY_FORMAT_VERSION;
+
+/// @name Read Functions
+/// @{
+
+/// Read a Document in binary format from the given input stream.
+/// @param doc The Document into which data is read.
+/// @param stream The input stream from which data is read.
+/// @throws ExceptionParseError if the document cannot be parsed, contains
+///    duplicate element names, or exceeds the maximum element depth.
+void readFromBinaryStream(DocumentPtr doc, std::istream& stream);
+
+/// Read a Document in binary format from the given filename.  The resulting
+/// Document, including the source URIs of its elements, matches that produced
+/// by readFromXmlFile for the XML document from which the binary file was
+/// written.
+/// @param doc The Document into which data is read.
+/// @param filename The filename from which data is read.  This argument can
+///    be supplied either as a FilePath or a standard string.
+/// @param searchPath An optional sequence of file paths that will be applied
+///    in order when searching for the given file.  This argument can be supplied
+///    either as a FileSearchPath, or as a standard string with paths separated
+///    by the PATH_SEPARATOR character.
+/// @throws ExceptionParseError if the document cannot be parsed.
+/// @throws ExceptionFileMissing if the file cannot be opened.
+void readFromBinaryFile(DocumentPtr doc,
+                        const FilePath& filename,
+                        const FileSearchPath& searchPath = FileSearchPath());
+
+/// @}
+/// @name Write Functions
+/// @{
+
+/// Write a Document in binary format to the given output stream.
+/// @param doc The Document to be written.
+/// @param stream The output stream to which data is written
+void writeToBinaryStream(DocumentPtr doc, std::ostream& stream);
+
+/// Write a Document in binary format to the given filename.
+/// @param doc The Document to be written.
+/// @param filename The filename to which data is written.  This argument can
+///    be supplied either as a FilePath or a standard string.
+void writeToBinaryFile(DocumentPtr doc, const FilePath& filename);
+
+/// @}
+
+} // namespace MaterialX
+
+#endif
@@ -138,6 +138,25 @@ bool FilePath::isDirectory() const
 #endif
 }
 
+int64_t FilePath::getModificationTime() const
+{
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesEx(asString().c_str(), GetFileExInfoStandard, &data))
+        return 0;
+    return ((int64_t) data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+#else
+    struct stat sb;
+    if (stat(asString().c_str(), &sb))
+        return 0;
+#if defined(__APPLE__)
+    return (int64_t) sb.st_mtimespec.tv_sec * 1000000000 + sb.st_mtimespec.tv_nsec;
+#else
+    return (int64_t) sb.st_mtim.tv_sec * 1000000000 + sb.st_mtim.tv_nsec;
+#endif
+#endif
+}
+
 FilePathVec FilePath::getFilesInDirectory(const string& extension) const
 {
     FilePathVec files;
@@ -11,6 +11,8 @@
 
 #include <MaterialXCore/Util.h>
 
+#include <cstdint>
+
 namespace MaterialX
 {
 
@@ -144,6 +146,11 @@ class FilePath
     /// Return true if the given path is a directory on the file system.
     bool isDirectory() const;
 
+    /// Return the last modification time of the given path on the file
+    /// system, as a platform-specific timestamp that changes whenever the
+    /// file is modified.  If the path does not exist, then zero is returned.
+    int64_t getModificationTime() const;
+
     /// Return a vector of all files in the given directory with the given extension.
     FilePathVec getFilesInDirectory(const string& extension) const;
 
@@ -8,6 +8,7 @@
 #include <MaterialXFormat/PugiXML/pugixml.hpp>
 
 #include <MaterialXCore/Types.h>
+#include <MaterialXCore/Util.h>
 
 #include <cstring>
 #include <fstream>
@@ -26,10 +27,10 @@ const string XINCLUDE_TAG = "xi:include";
 const string XINCLUDE_NAMESPACE = "xmlns:xi";
 const string XINCLUDE_URL = "http://www.w3.org/2001/XInclude";
 
+void childElementFromXml(const xml_node& xmlChild, ElementPtr elem, const XmlReadOptions* readOptions);
+
 void elementFromXml(const xml_node& xmlNode, ElementPtr elem, const XmlReadOptions* readOptions)
 {
-    bool skipConflictingElements = readOptions && readOptions->skipConflictingElements;
-
     // Store attributes in element.
     for (const xml_attribute& xmlAttr : xmlNode.attributes())
     {
@@ -42,99 +43,210 @@ void elementFromXml(const xml_node& xmlNode, ElementPtr elem, const XmlReadOptio
     // Create child elements and recurse.
     for (const xml_node& xmlChild : xmlNode.children())
     {
-        string category = xmlChild.name();
-        string name;
-        for (const xml_attribute& xmlAttr : xmlChild.attributes())
-        {
-            if (xmlAttr.name() == Element::NAME_ATTRIBUTE)
-            {
-                name = xmlAttr.value();
-                break;
-            }
-        }
+        childElementFromXml(xmlChild, elem, readOptions);
+    }
+}
 
-        // Check for duplicate elements.
-        ConstElementPtr previous = elem->getChild(name);
-        if (previous && skipConflictingElements)
-        {
-            continue;
-        }
+void childElementFromXml(const xml_node& xmlChild, ElementPtr elem, const XmlReadOptions* readOptions)
+{
+    bool skipConflictingElements = readOptions && readOptions->skipConflictingElements;
 
-        // Create the new element.
-        ElementPtr child = elem->addChildOfCategory(category, name, !previous);
-        elementFromXml(xmlChild, child, readOptions);
+    string category = xmlChild.name();
+    string name = xmlChild.attribute(Element::NAME_ATTRIBUTE.c_str()).value();
 
-        // Check for conflicting elements.
-        if (previous && *previous != *child)
-        {
-            throw Exception("Duplicate element with conflicting content: " + name);
-        }
+    // Check for duplicate elements.
+    ConstElementPtr previous = elem->getChild(name);
+    if (previous && skipConflictingElements)
+    {
+        return;
+    }
+
+    // Create the new element.
+    ElementPtr child = elem->addChildOfCategory(category, name, !previous);
+    elementFromXml(xmlChild, child, readOptions);
+
+    // Check for conflicting elements.
+    if (previous && *previous != *child)
+    {
+        throw Exception("Duplicate element with conflicting content: " + name);
     }
 }
 
-void elementToXml(ConstElementPtr elem, xml_node& xmlNode, const XmlWriteOptions* writeOptions)
+// Streaming XML serializer, writing elements directly to an output stream
+// with the same formatting as pugixml's default indented output.
+class XmlStreamWriter
 {
-    bool writeXIncludeEnable = writeOptions ? writeOptions->writeXIncludeEnable : true;
-    ElementPredicate elementPredicate = writeOptions ? writeOptions->elementPredicate : nullptr;
-
-    // Store attributes in XML.
-    if (!elem->getName().empty())
+  public:
+    XmlStreamWriter(std::ostream& stream, const string& docSourceUri, const XmlWriteOptions* writeOptions) :
+        _stream(stream),
+        _docSourceUri(docSourceUri),
+        _writeXIncludeEnable(writeOptions ? writeOptions->writeXIncludeEnable : true),
+        _elementPredicate(writeOptions ? writeOptions->elementPredicate : nullptr)
     {
-        xmlNode.append_attribute(Element::NAME_ATTRIBUTE.c_str()) = elem->getName().c_str();
+        _buffer.reserve(BUFFER_SIZE + BUFFER_SIZE / 4);
     }
-    for (const string& attrName : elem->getAttributeNames())
+
+    void writeDocument(ConstDocumentPtr doc)
     {
-        xml_attribute xmlAttr = xmlNode.append_attribute(attrName.c_str());
-        xmlAttr.set_value(elem->getAttribute(attrName).c_str());
+        _buffer += "<?xml version=\"1.0\"?>\n";
+        writeElement(doc, "materialx", 0);
+        _buffer += '\n';
+        flush();
     }
 
-    // Create child nodes and recurse.
-    StringSet writtenSourceFiles;
-    for (const ConstElementPtr& child : elem->getChildren())
+  private:
+    void writeElement(ConstElementPtr elem, const string& tag, size_t depth)
     {
-        if (elementPredicate && !elementPredicate(child))
+        // Gather child elements and XInclude references, which must be known
+        // before the start tag is complete.
+        vector<std::pair<ConstElementPtr, string>> children;
+        StringSet writtenSourceFiles;
+        for (const ElementPtr& child : elem->getChildren())
         {
-            continue;
-        }
+            if (_elementPredicate && !_elementPredicate(child))
+            {
+                continue;
+            }
 
-        // Write XInclude references if requested.
-        if (writeXIncludeEnable && child->hasSourceUri())
-        {
-            string sourceUri = child->getSourceUri();
-            if (sourceUri != elem->getDocument()->getSourceUri())
+            // Write XInclude references if requested.
+            if (_writeXIncludeEnable && child->hasSourceUri())
             {
-                if (!writtenSourceFiles.count(sourceUri))
+                const string& sourceUri = child->getSourceUri();
+                if (sourceUri != _docSourceUri)
                 {
-                    if (!xmlNode.attribute(XINCLUDE_NAMESPACE.c_str()))
+                    if (!writtenSourceFiles.count(sourceUri))
                     {
-                        xmlNode.append_attribute(XINCLUDE_NAMESPACE.c_str()) = XINCLUDE_URL.c_str();
+                        // Write relative include paths in Posix format, and absolute
+                        // include paths in native format.
+                        FilePath includePath(sourceUri);
+                        FilePath::Format includeFormat = includePath.isAbsolute() ?
+                            FilePath::FormatNative : FilePath::FormatPosix;
+                        children.emplace_back(nullptr, includePath.asString(includeFormat));
+                        writtenSourceFiles.insert(sourceUri);
                     }
-                    xml_node includeNode = xmlNode.append_child(XINCLUDE_TAG.c_str());
-                    xml_attribute includeAttr = includeNode.append_attribute("href");
-                    FilePath includePath(sourceUri);
+                    continue;
+                }
+            }
 
-                    // Write relative include paths in Posix format, and absolute
-                    // include paths in native format.
-                    FilePath::Format includeFormat = includePath.isAbsolute() ?
-                        FilePath::FormatNative : FilePath::FormatPosix;
-                    includeAttr.set_value(includePath.asString(includeFormat).c_str());
+            children.emplace_back(child, EMPTY_STRING);
+        }
 
-                    writtenSourceFiles.insert(sourceUri);
-                }
-                continue;
+        // Write the start tag and attributes.
+        _buffer.append(depth * 2, ' ');
+        _buffer += '<';
+        writeName(tag);
+        if (!elem->getName().empty())
+        {
+            writeAttribute(Element::NAME_ATTRIBUTE, elem->getName());
+        }
+        for (const string& attrName : elem->getAttributeNames())
+        {
+            writeAttribute(attrName, elem->getAttribute(attrName));
+        }
+        if (!writtenSourceFiles.empty() && !elem->hasAttribute(XINCLUDE_NAMESPACE))
+        {
+            writeAttribute(XINCLUDE_NAMESPACE, XINCLUDE_URL);
+        }
+        if (children.empty())
+        {
+            _buffer += " />";
+            return;
+        }
+        _buffer += '>';
+
+        // Write child elements and recurse.
+        for (const auto& child : children)
+        {
+            _buffer += '\n';
+            if (child.first)
+            {
+                writeElement(child.first, child.first->getCategory(), depth + 1);
+            }
+            else
+            {
+                _buffer.append((depth + 1) * 2, ' ');
+                _buffer += '<';
+                _buffer += XINCLUDE_TAG;
+                writeAttribute("href", child.second);
+                _buffer += " />";
             }
         }
 
-        xml_node xmlChild = xmlNode.append_child(child->getCategory().c_str());
-        elementToXml(child, xmlChild, writeOptions);
+        // Write the end tag.
+        _buffer += '\n';
+        _buffer.append(depth * 2, ' ');
+        _buffer += "</";
+        writeName(tag);
+        _buffer += '>';
+        if (_buffer.size() >= BUFFER_SIZE)
+        {
+            flush();
+        }
+    }
+
+    void writeName(const string& name)
+    {
+        _buffer += name.empty() ? ":anonymous" : name.c_str();
     }
-}
 
-void xmlDocumentFromFile(xml_document& xmlDoc, FilePath filename, FileSearchPath searchPath)
+    void writeAttribute(const string& name, const string& value)
+    {
+        _buffer += ' ';
+        writeName(name);
+        _buffer += "=\"";
+        for (const char* ch = value.c_str(); *ch; ch++)
+        {
+            unsigned char code = (unsigned char) *ch;
+            if (code == '&')
+            {
+                _buffer += "&amp;";
+            }
+            else if (code == '"')
+            {
+                _buffer += "&quot;";
+            }
+            else if (code < 32 && code != '\t')
+            {
+                _buffer += "&#";
+                _buffer += (char) ('0' + code / 10);
+                _buffer += (char) ('0' + code % 10);
+                _buffer += ';';
+            }
+            else
+            {
+                _buffer += *ch;
+            }
+        }
+        _buffer += '"';
+    }
+
+    void flush()
+    {
+        _stream.write(_buffer.data(), (std::streamsize) _buffer.size());
+        _buffer.clear();
+    }
+
+  private:
+    static const size_t BUFFER_SIZE = 1 << 16;
+
+    std::ostream& _stream;
+    string _docSourceUri;
+    bool _writeXIncludeEnable;
+    ElementPredicate _elementPredicate;
+    string _buffer;
+};
+
+// Resolve the given filename against the given search path, followed by
+// the environment search path.
+FilePath resolveXmlFilename(const FilePath& filename, FileSearchPath searchPath)
 {
     searchPath.append(getEnvironmentPath());
+    return searchPath.find(filename);
+}
 
-    filename = searchPath.find(filename);
+void xmlDocumentFromFile(xml_document& xmlDoc, FilePath filename, const FileSearchPath& searchPath)
+{
+    filename = resolveXmlFilename(filename, searchPath);
 
     xml_parse_result result = xmlDoc.load_file(filename.asString().c_str());
     if (!result)
@@ -153,74 +265,289 @@ void xmlDocumentFromFile(xml_document& xmlDoc, FilePath filename, FileSearchPath
     }
 }
 
+void readDeferredXInclude(DocumentPtr doc, const string& filename, const FileSearchPath& searchPath, const XmlReadOptions* readOptions);
+
 void processXIncludes(DocumentPtr doc, xml_node& xmlNode, const FileSearchPath& searchPath, const XmlReadOptions* readOptions)
 {
-    // Search path for includes. Set empty and then evaluated once in the iteration through xml includes.
-    FileSearchPath includeSearchPath;
-
-    XmlReadFunction readXIncludeFunction = readOptions ? readOptions->readXIncludeFunction : readFromXmlFile;
+    // Gather XInclude references in document order, removing the include
+    // directives from the XML tree.
+    StringVec filenames;
     xml_node xmlChild = xmlNode.first_child();
     while (xmlChild)
     {
         if (xmlChild.name() == XINCLUDE_TAG)
         {
-            // Read XInclude references if requested.
-            if (readXIncludeFunction)
+            filenames.push_back(xmlChild.attribute("href").value());
+
+            xml_node includeNode = xmlChild;
+            xmlChild = xmlChild.next_sibling();
+            xmlNode.remove_child(includeNode);
+        }
+        else
+        {
+            xmlChild = xmlChild.next_sibling();
+        }
+    }
+
+    // Read XInclude references if requested.
+    XmlReadFunction readXIncludeFunction = readOptions ? readOptions->readXIncludeFunction : readFromXmlFile;
+    if (!readXIncludeFunction || filenames.empty())
+    {
+        return;
+    }
+
+    // Determine the number of worker threads.
+    unsigned int threadCount = 1;
+    if (readOptions && readOptions->parallelXIncludes)
+    {
+        threadCount = getWorkerThreadCount(readOptions->threadCount, filenames.size());
+    }
+    bool parallel = threadCount > 1;
+
+    // Prepend the directory of the parent to the search path, to accommodate
+    // includes relative to the parent file location.
+    FileSearchPath includeSearchPath = searchPath;
+    string parentUri = doc->getSourceUri();
+    if (!parentUri.empty())
+    {
+        FilePath filePath = searchPath.find(parentUri);
+        if (!filePath.isEmpty())
+        {
+            includeSearchPath.prepend(filePath.getParentPath());
+        }
+    }
+
+    // Deferred includes at the scope of the top-level document are read
+    // directly, with their nested includes read as usual.
+    if (readOptions && readOptions->deferLibraryElements && readOptions->parentXIncludes.empty())
+    {
+        for (const string& filename : filenames)
+        {
+            readDeferredXInclude(doc, filename, includeSearchPath, readOptions);
+        }
+        return;
+    }
+
+    // The cache applies only to includes at the scope of the top-level
+    // document, whose cached contents then cover any nested includes.
+    XIncludeCachePtr cache;
+    if (readOptions && readOptions->parentXIncludes.empty())
+    {
+        cache = readOptions->xincludeCache;
+    }
+
+    // Read each included file into its own library document, storing any
+    // exception so that it can be reported in document order.
+    vector<ConstDocumentPtr> libraries(filenames.size());
+    vector<std::exception_ptr> errors(filenames.size());
+    auto readXInclude = [&](size_t index)
+    {
+        try
+        {
+            const string& filename = filenames[index];
+
+            // Check for XInclude cycles.
+            if (readOptions)
             {
-                string filename = xmlChild.attribute("href").value();
+                const StringVec& parents = readOptions->parentXIncludes;
+                if (std::find(parents.begin(), parents.end(), filename) != parents.end())
+                {
+                    throw ExceptionParseError("XInclude cycle detected.");
+                }
+            }
 
-                // Check for XInclude cycles.
-                if (readOptions)
+            // Return the cached document if it is up to date.
+            FilePath resolvedPath;
+            if (cache)
+            {
+                resolvedPath = resolveXmlFilename(filename, includeSearchPath);
+                libraries[index] = cache->getDocument(filename, resolvedPath);
+                if (libraries[index])
                 {
-                    const StringVec& parents = readOptions->parentXIncludes;
-                    if (std::find(parents.begin(), parents.end(), filename) != parents.end())
-                    {
-                        throw ExceptionParseError("XInclude cycle detected.");
-                    }
+                    return;
                 }
+            }
+
+            XmlReadOptions xiReadOptions = readOptions ? *readOptions : XmlReadOptions();
+            xiReadOptions.parentXIncludes.push_back(filename);
 
-                // Read the included file into a library document.
-                DocumentPtr library = createDocument();
-                XmlReadOptions xiReadOptions = readOptions ? *readOptions : XmlReadOptions();
-                xiReadOptions.parentXIncludes.push_back(filename);
+            // Nested includes are read serially within each worker thread,
+            // bounding the total number of threads, and within each cached
+            // read, so that their dependencies may be recorded in order.
+            if (parallel || cache)
+            {
+                xiReadOptions.parallelXIncludes = false;
+            }
 
-                // Prepend the directory of the parent to accommodate
-                // includes relative to the parent file location.
-                if (includeSearchPath.isEmpty())
+            // Record the files read by nested includes as dependencies of
+            // the cached document.
+            shared_ptr<vector<XIncludeCache::Dependency>> dependencies;
+            if (cache)
+            {
+                dependencies = std::make_shared<vector<XIncludeCache::Dependency>>();
+                dependencies->emplace_back(resolvedPath, resolvedPath.getModificationTime());
+                XmlReadFunction nestedReadFunction = readXIncludeFunction;
+                xiReadOptions.readXIncludeFunction =
+                    [nestedReadFunction, dependencies](DocumentPtr nestedDoc, const FilePath& nestedFilename,
+                                                       const FileSearchPath& nestedSearchPath, const XmlReadOptions* nestedOptions)
                 {
-                    string parentUri = doc->getSourceUri();
-                    if (!parentUri.empty())
-                    {
-                        FilePath filePath = searchPath.find(parentUri);
-                        if (!filePath.isEmpty())
-                        {
-                            // Remove the file name from the path as we want the path to the containing folder.
-                            includeSearchPath = searchPath;
-                            includeSearchPath.prepend(filePath.getParentPath());
-                        }
-                    }
-                    // Set default search path if no parent path found
-                    if (includeSearchPath.isEmpty())
-                    {
-                        includeSearchPath = searchPath;
-                    }
-                }
-                readXIncludeFunction(library, filename, includeSearchPath, &xiReadOptions);
+                    FilePath nestedPath = resolveXmlFilename(nestedFilename, nestedSearchPath);
+                    dependencies->emplace_back(nestedPath, nestedPath.getModificationTime());
+                    nestedReadFunction(nestedDoc, nestedFilename, nestedSearchPath, nestedOptions);
+                };
+            }
 
-                // Import the library document.
-                doc->importLibrary(library, readOptions);
+            DocumentPtr library = createDocument();
+            readXIncludeFunction(library, filename, includeSearchPath, &xiReadOptions);
+            if (cache)
+            {
+                cache->setDocument(filename, resolvedPath, library, *dependencies);
             }
+            libraries[index] = library;
+        }
+        catch (...)
+        {
+            errors[index] = std::current_exception();
+        }
+    };
 
-            // Remove include directive.
-            xml_node includeNode = xmlChild;
-            xmlChild = xmlChild.next_sibling();
-            xmlNode.remove_child(includeNode);
+    // Read included files in parallel on a pool of worker threads.
+    if (parallel)
+    {
+        runParallelTasks(filenames.size(), threadCount, [&](size_t index, unsigned int)
+        {
+            readXInclude(index);
+        });
+    }
+
+    // Import the library documents in document order.
+    for (size_t i = 0; i < filenames.size(); i++)
+    {
+        if (!parallel)
+        {
+            readXInclude(i);
         }
-        else
+        if (errors[i])
         {
-            xmlChild = xmlChild.next_sibling();
+            std::rethrow_exception(errors[i]);
+        }
+        doc->importLibrary(libraries[i], readOptions);
+    }
+}
+
+// Return true if the given XML node at the root of an included document
+// may be registered as a deferred element.
+bool isDeferrableXml(const xml_node& xmlNode)
+{
+    if (xmlNode.attribute(Element::NAME_ATTRIBUTE.c_str()).empty())
+    {
+        return false;
+    }
+    string category = xmlNode.name();
+    if (category == NodeDef::CATEGORY)
+    {
+        return true;
+    }
+    if (category == Implementation::CATEGORY || category == NodeGraph::CATEGORY)
+    {
+        return !xmlNode.attribute(InterfaceElement::NODE_DEF_ATTRIBUTE.c_str()).empty();
+    }
+    return false;
+}
+
+// Qualify the given name with the namespace of the given XML node, falling
+// back to the namespace at the scope of the given element.
+string qualifyXmlName(const xml_node& xmlNode, ConstElementPtr scope, const string& name)
+{
+    string ns = xmlNode.attribute(Element::NAMESPACE_ATTRIBUTE.c_str()).value();
+    return ns.empty() ? scope->getQualifiedName(name) : ns + NAME_PREFIX_SEPARATOR + name;
+}
+
+// Read the given XInclude reference into the given document, registering its
+// deferrable elements as deferred elements of the document, and importing
+// its remaining content as a library.
+void readDeferredXInclude(DocumentPtr doc, const string& filename, const FileSearchPath& searchPath, const XmlReadOptions* readOptions)
+{
+    XmlReadOptions xiReadOptions = readOptions ? *readOptions : XmlReadOptions();
+    xiReadOptions.parentXIncludes.push_back(filename);
+
+    // The XML document is retained by the loaders of deferred elements.
+    shared_ptr<xml_document> xmlDoc = std::make_shared<xml_document>();
+    xmlDocumentFromFile(*xmlDoc, filename, searchPath);
+    xml_node xmlRoot = xmlDoc->child(Document::CATEGORY.c_str());
+
+    DocumentPtr library = createDocument();
+    library->setSourceUri(filename);
+    vector<std::pair<string, xml_node>> deferredNodes;
+    {
+        ScopedUpdate update(library);
+        library->onRead();
+        if (xmlRoot)
+        {
+            processXIncludes(library, xmlRoot, searchPath, &xiReadOptions);
+            for (const xml_attribute& xmlAttr : xmlRoot.attributes())
+            {
+                if (xmlAttr.name() != Element::NAME_ATTRIBUTE)
+                {
+                    library->setAttribute(xmlAttr.name(), xmlAttr.value());
+                }
+            }
+
+            // Elements are only deferred from documents of the current version,
+            // which require no upgrade, and when their names are not already
+            // in use.
+            std::pair<int, int> libraryVersion = library->getVersionIntegers();
+            std::tuple<int, int, int> currentVersion = getVersionIntegers();
+            bool deferEnable = libraryVersion.first == std::get<0>(currentVersion) &&
+                               libraryVersion.second == std::get<1>(currentVersion);
+            for (const xml_node& xmlChild : xmlRoot.children())
+            {
+                if (deferEnable && isDeferrableXml(xmlChild))
+                {
+                    string name = xmlChild.attribute(Element::NAME_ATTRIBUTE.c_str()).value();
+                    string qualifiedName = qualifyXmlName(xmlChild, library, name);
+                    if (!library->getChild(name) && !doc->getChild(qualifiedName) && !doc->hasDeferredElement(qualifiedName))
+                    {
+                        deferredNodes.emplace_back(qualifiedName, xmlChild);
+                        continue;
+                    }
+                    doc->loadDeferredElement(qualifiedName);
+                }
+                childElementFromXml(xmlChild, library, &xiReadOptions);
+            }
         }
     }
+    library->upgradeVersion();
+    doc->importLibrary(library, readOptions);
+
+    // Deferred elements are loaded through a library document with the root
+    // attributes and source URI of the include, matching the behavior of
+    // importLibrary.
+    DocumentPtr context = createDocument();
+    for (const string& attrName : library->getAttributeNames())
+    {
+        context->setAttribute(attrName, library->getAttribute(attrName));
+    }
+    context->setSourceUri(library->getSourceUri());
+    ConstElementPtr keyScope = library->hasNamespace() ? ConstElementPtr(library) : ConstElementPtr(doc);
+    for (const auto& deferredNode : deferredNodes)
+    {
+        xml_node xmlChild = deferredNode.second;
+        string node = xmlChild.attribute(NodeDef::NODE_ATTRIBUTE.c_str()).value();
+        string nodeDef = xmlChild.attribute(InterfaceElement::NODE_DEF_ATTRIBUTE.c_str()).value();
+        doc->addDeferredElement(deferredNode.first,
+                                node.empty() ? EMPTY_STRING : qualifyXmlName(xmlChild, keyScope, node),
+                                nodeDef.empty() ? EMPTY_STRING : qualifyXmlName(xmlChild, keyScope, nodeDef),
+                                [xmlDoc, xmlChild, context](DocumentPtr target)
+        {
+            DocumentPtr library = createDocument();
+            library->copyContentFrom(context);
+            childElementFromXml(xmlChild, library, nullptr);
+            CopyOptions copyOptions;
+            copyOptions.skipConflictingElements = true;
+            target->importLibrary(library, &copyOptions);
+        });
+    }
 }
 
 void documentFromXml(DocumentPtr doc,
@@ -248,8 +575,74 @@ void documentFromXml(DocumentPtr doc,
 //
 
 XmlReadOptions::XmlReadOptions() :
-    readXIncludeFunction(readFromXmlFile)
+    readXIncludeFunction(readFromXmlFile),
+    parallelXIncludes(false),
+    threadCount(0),
+    deferLibraryElements(false)
+{
+}
+
+//
+// XIncludeCache methods
+//
+
+ConstDocumentPtr XIncludeCache::getDocument(const string& reference, const FilePath& path)
+{
+    std::lock_guard<std::mutex> guard(_mutex);
+    auto it = _entries.find(reference + "\n" + path.asString());
+    if (it != _entries.end())
+    {
+        bool upToDate = true;
+        for (const Dependency& dependency : it->second.dependencies)
+        {
+            if (dependency.first.getModificationTime() != dependency.second)
+            {
+                upToDate = false;
+                break;
+            }
+        }
+        if (upToDate)
+        {
+            _hitCount++;
+            return it->second.doc;
+        }
+        _entries.erase(it);
+    }
+    _missCount++;
+    return nullptr;
+}
+
+void XIncludeCache::setDocument(const string& reference, const FilePath& path,
+                                ConstDocumentPtr doc, const vector<Dependency>& dependencies)
 {
+    std::lock_guard<std::mutex> guard(_mutex);
+    _entries[reference + "\n" + path.asString()] = { doc, dependencies };
+}
+
+size_t XIncludeCache::getDocumentCount() const
+{
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _entries.size();
+}
+
+void XIncludeCache::clear()
+{
+    std::lock_guard<std::mutex> guard(_mutex);
+    _entries.clear();
+    _hitCount = 0;
+    _missCount = 0;
+}
+
+size_t XIncludeCache::getHitCount() const
+{
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _hitCount;
+}
+
+size_t XIncludeCache::getMissCount() const
+{
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _missCount;
 }
 
 //
@@ -321,11 +714,10 @@ void writeToXmlStream(DocumentPtr doc, std::ostream& stream, const XmlWriteOptio
 {
     ScopedUpdate update(doc);
     doc->onWrite();
+    doc->loadDeferredElements();
 
-    xml_document xmlDoc;
-    xml_node xmlRoot = xmlDoc.append_child("materialx");
-    elementToXml(doc, xmlRoot, writeOptions);
-    xmlDoc.save(stream, "  ");
+    XmlStreamWriter writer(stream, doc->getSourceUri(), writeOptions);
+    writer.writeDocument(doc);
 }
 
 void writeToXmlFile(DocumentPtr doc, const FilePath& filename, const XmlWriteOptions* writeOptions)
@@ -15,10 +15,16 @@
 
 #include <MaterialXFormat/File.h>
 
+#include <mutex>
+
 namespace MaterialX
 {
 
 class XmlReadOptions;
+class XIncludeCache;
+
+/// A shared pointer to an XIncludeCache
+using XIncludeCachePtr = shared_ptr<XIncludeCache>;
 
 extern const string MTLX_EXTENSION;
 
@@ -41,6 +47,106 @@ class XmlReadOptions : public CopyOptions
     /// The vector of parent XIncludes at the scope of the current document.
     /// Defaults to an empty vector.
     StringVec parentXIncludes;
+
+    /// If true, then the XInclude references at the scope of each document
+    /// will be read in parallel on a pool of worker threads, and then merged
+    /// into the document in their original order.  The readXIncludeFunction
+    /// must support concurrent calls on distinct documents.  Defaults to false.
+    bool parallelXIncludes;
+
+    /// The number of worker threads used when parallelXIncludes is true, or
+    /// zero to use the number of hardware threads.  In either case, no more
+    /// threads are used than there are XInclude references to read.
+    /// Defaults to zero.
+    unsigned int threadCount;
+
+    /// If provided, then XInclude references at the scope of the top-level
+    /// document will be read through the given cache, parsing each included
+    /// file once and importing its contents into subsequent documents.
+    /// Defaults to nullptr.
+    XIncludeCachePtr xincludeCache;
+
+    /// If true, then the NodeDef, Implementation and NodeGraph elements of
+    /// XInclude references at the scope of the top-level document will be
+    /// indexed rather than created on read, and registered as deferred
+    /// elements of the document, to be loaded when they are first resolved
+    /// by a lookup such as getNodeDef, getMatchingNodeDefs or
+    /// getImplementation.  Deferred XIncludes are read directly from their
+    /// files, bypassing readXIncludeFunction, parallelXIncludes and
+    /// xincludeCache.  Defaults to false.
+    bool deferLibraryElements;
+};
+
+/// @class XIncludeCache
+/// A process-wide cache of documents read through XInclude references.
+///
+/// Each cached document is keyed by the reference string and resolved path
+/// of its included file, and is read again when the modification time of
+/// that file, or of any file that it includes in turn, has changed.  A cache
+/// may be shared between threads, but should only be shared between read
+/// operations with equivalent read options.
+class XIncludeCache
+{
+  public:
+    XIncludeCache() :
+        _hitCount(0),
+        _missCount(0)
+    {
+    }
+    ~XIncludeCache() { }
+
+    /// Create a new XInclude cache.
+    static XIncludeCachePtr create()
+    {
+        return std::make_shared<XIncludeCache>();
+    }
+
+    /// A file dependency of a cached document, with its modification time
+    /// at the point it was read.
+    using Dependency = std::pair<FilePath, int64_t>;
+
+    /// @name Cached Documents
+    /// @{
+
+    /// Return the cached document for the given XInclude reference and
+    /// resolved path, or nullptr if no up-to-date document is cached.
+    ConstDocumentPtr getDocument(const string& reference, const FilePath& path);
+
+    /// Store the document read from the given XInclude reference and
+    /// resolved path, along with the file dependencies that were read
+    /// to construct it.
+    void setDocument(const string& reference, const FilePath& path,
+                     ConstDocumentPtr doc, const vector<Dependency>& dependencies);
+
+    /// Return the number of cached documents.
+    size_t getDocumentCount() const;
+
+    /// Clear all cached documents and statistics.
+    void clear();
+
+    /// @}
+    /// @name Statistics
+    /// @{
+
+    /// Return the number of requests satisfied by a cached document.
+    size_t getHitCount() const;
+
+    /// Return the number of requests not satisfied by a cached document.
+    size_t getMissCount() const;
+
+    /// @}
+
+  private:
+    struct Entry
+    {
+        ConstDocumentPtr doc;
+        vector<Dependency> dependencies;
+    };
+
+    mutable std::mutex _mutex;
+    std::unordered_map<string, Entry> _entries;
+    size_t _hitCount;
+    size_t _missCount;
 };
 
 /// @class XmlWriteOptions
@@ -0,0 +1,142 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXTest/Catch/catch.hpp>
+
+#include <MaterialXTest/XmlIoUtil.h>
+
+#include <MaterialXFormat/BinaryIo.h>
+#include <MaterialXFormat/File.h>
+#include <MaterialXFormat/XmlIo.h>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+namespace mx = MaterialX;
+
+using XmlIoUtil::getDocumentsInTree;
+
+TEST_CASE("Binary round trip", "[binaryio]")
+{
+    mx::FileSearchPath searchPath("libraries/stdlib");
+    for (const mx::FilePath& file : getDocumentsInTree("resources/Materials"))
+    {
+        mx::DocumentPtr doc = mx::createDocument();
+        mx::readFromXmlFile(doc, file, searchPath);
+
+        std::stringstream stream;
+        mx::writeToBinaryStream(doc, stream);
+        mx::DocumentPtr binaryDoc = mx::createDocument();
+        mx::readFromBinaryStream(binaryDoc, stream);
+
+        // Compare the documents, including the source URIs of their elements.
+        INFO(file.asString());
+        REQUIRE(*binaryDoc == *doc);
+        REQUIRE(binaryDoc->getSourceUri() == doc->getSourceUri());
+        REQUIRE(mx::writeToXmlString(binaryDoc) == mx::writeToXmlString(doc));
+    }
+
+    // Round trip through a binary file.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::readFromXmlFile(doc, "resources/Materials/Examples/Syntax/PaintMaterials.mtlx", searchPath);
+    mx::FilePath filename = "PaintMaterials." + mx::MTLXB_EXTENSION;
+    mx::writeToBinaryFile(doc, filename);
+    mx::DocumentPtr binaryDoc = mx::createDocument();
+    mx::readFromBinaryFile(binaryDoc, filename);
+    REQUIRE(*binaryDoc == *doc);
+    REQUIRE(binaryDoc->validate());
+    std::remove(filename.asString().c_str());
+
+    // Invalid binary documents.
+    std::stringstream stream;
+    mx::writeToBinaryStream(doc, stream);
+    std::string data = stream.str();
+    for (const std::string& invalidData : { std::string("<?xml version=\"1.0\"?>"),
+                                            data.substr(0, data.size() / 2),
+                                            data + '\0' })
+    {
+        std::istringstream invalidStream(invalidData);
+        REQUIRE_THROWS_AS(mx::readFromBinaryStream(mx::createDocument(), invalidStream), mx::ExceptionParseError&);
+    }
+
+    // Excessively nested elements.
+    mx::DocumentPtr nestedDoc = mx::createDocument();
+    mx::ElementPtr nestedElem = nestedDoc;
+    for (int i = 0; i < 1000; i++)
+    {
+        nestedElem = nestedElem->addChildOfCategory("element", "nested");
+    }
+    std::stringstream nestedStream;
+    mx::writeToBinaryStream(nestedDoc, nestedStream);
+    REQUIRE_THROWS_AS(mx::readFromBinaryStream(mx::createDocument(), nestedStream), mx::ExceptionParseError&);
+
+    // Duplicate element names, produced by editing the string table.
+    mx::DocumentPtr duplicateDoc = mx::createDocument();
+    duplicateDoc->addChildOfCategory("element", "duplicate1");
+    duplicateDoc->addChildOfCategory("element", "duplicate2");
+    std::stringstream duplicateStream;
+    mx::writeToBinaryStream(duplicateDoc, duplicateStream);
+    std::string duplicateData = duplicateStream.str();
+    duplicateData.replace(duplicateData.find("duplicate2"), 10, "duplicate1");
+    std::istringstream invalidStream(duplicateData);
+    REQUIRE_THROWS_AS(mx::readFromBinaryStream(mx::createDocument(), invalidStream), mx::ExceptionParseError&);
+    REQUIRE_THROWS_AS(mx::readFromBinaryFile(mx::createDocument(), "Missing." + mx::MTLXB_EXTENSION), mx::ExceptionFileMissing&);
+}
+
+TEST_CASE("Binary load benchmark", "[binaryio][benchmark][.]")
+{
+    const int ROUND_COUNT = 5;
+    mx::FileSearchPath searchPath("libraries/stdlib");
+
+    // Write binary copies of all example documents, along with a large
+    // document containing many copies of the standard library.
+    mx::FilePathVec files = getDocumentsInTree("resources/Materials");
+    mx::DocumentPtr largeDoc = XmlIoUtil::createLargeDocument(50);
+    mx::writeToXmlFile(largeDoc, "large_document.mtlx");
+    files.push_back("large_document.mtlx");
+
+    mx::FilePathVec binaryFiles;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        mx::DocumentPtr doc = mx::createDocument();
+        mx::readFromXmlFile(doc, files[i], searchPath);
+        mx::FilePath binaryFile = "benchmark" + std::to_string(i) + "." + mx::MTLXB_EXTENSION;
+        mx::writeToBinaryFile(doc, binaryFile);
+        binaryFiles.push_back(binaryFile);
+    }
+
+    // Compare load times, reporting the large document separately.
+    double xmlTime[2] = { 0.0, 0.0 };
+    double binaryTime[2] = { 0.0, 0.0 };
+    for (int round = 0; round < ROUND_COUNT; round++)
+    {
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            size_t index = (i + 1 == files.size()) ? 1 : 0;
+
+            auto start = std::chrono::steady_clock::now();
+            mx::DocumentPtr xmlDoc = mx::createDocument();
+            mx::readFromXmlFile(xmlDoc, files[i], searchPath);
+            auto xmlEnd = std::chrono::steady_clock::now();
+            mx::DocumentPtr binaryDoc = mx::createDocument();
+            mx::readFromBinaryFile(binaryDoc, binaryFiles[i]);
+            auto binaryEnd = std::chrono::steady_clock::now();
+
+            xmlTime[index] += std::chrono::duration<double, std::milli>(xmlEnd - start).count();
+            binaryTime[index] += std::chrono::duration<double, std::milli>(binaryEnd - xmlEnd).count();
+        }
+    }
+    for (const mx::FilePath& binaryFile : binaryFiles)
+    {
+        std::remove(binaryFile.asString().c_str());
+    }
+    std::remove("large_document.mtlx");
+
+    std::cout << files.size() - 1 << " example documents: " <<
+        xmlTime[0] / ROUND_COUNT << " ms XML load, " << binaryTime[0] / ROUND_COUNT << " ms binary load" << std::endl;
+    std::cout << "Large document: " <<
+        xmlTime[1] / ROUND_COUNT << " ms XML load, " << binaryTime[1] / ROUND_COUNT << " ms binary load" << std::endl;
+}
@@ -10,6 +10,11 @@
 #include <MaterialXFormat/XmlIo.h>
 #include <MaterialXGenShader/Util.h>
 
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
 namespace mx = MaterialX;
 
 TEST_CASE("Document", "[document]")
@@ -112,6 +117,358 @@ TEST_CASE("Document", "[document]")
     REQUIRE(doc->validate());
 }
 
+TEST_CASE("Document cache", "[document]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibrary(mx::FilePath::getCurrentPath() / mx::FilePath("libraries/stdlib/stdlib_defs.mtlx"), doc);
+    REQUIRE(!doc->getMatchingNodeDefs("add").empty());
+
+    // Add and edit a nodedef after the cache has been built.
+    mx::NodeDefPtr nodeDef = doc->addNodeDef("ND_custom", "float", "custom");
+    REQUIRE(doc->getMatchingNodeDefs("custom").size() == 1);
+    nodeDef->setNodeString("custom2");
+    REQUIRE(doc->getMatchingNodeDefs("custom").empty());
+    REQUIRE(doc->getMatchingNodeDefs("custom2").size() == 1);
+
+    // Add and edit an implementation.
+    mx::ImplementationPtr impl = doc->addImplementation("IM_custom");
+    impl->setNodeDef(nodeDef);
+    REQUIRE(doc->getMatchingImplementations("ND_custom").size() == 1);
+    impl->removeAttribute(mx::InterfaceElement::NODE_DEF_ATTRIBUTE);
+    REQUIRE(doc->getMatchingImplementations("ND_custom").empty());
+
+    // Add and edit connections within a node graph.
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+    mx::NodePtr constant = nodeGraph->addNode("constant");
+    mx::OutputPtr output = nodeGraph->addOutput();
+    output->setConnectedNode(constant);
+    REQUIRE(doc->getMatchingPorts(constant->getName()).size() == 1);
+
+    // Apply a namespace to the node graph.
+    nodeGraph->setNamespace("ns");
+    REQUIRE(doc->getMatchingPorts(constant->getName()).empty());
+    REQUIRE(doc->getMatchingPorts("ns:" + constant->getName()).size() == 1);
+    nodeGraph->removeAttribute(mx::Element::NAMESPACE_ATTRIBUTE);
+    REQUIRE(doc->getMatchingPorts(constant->getName()).size() == 1);
+
+    // Copy content into an existing element.
+    mx::NodeGraphPtr nodeGraph2 = doc->addNodeGraph();
+    nodeGraph2->copyContentFrom(nodeGraph);
+    REQUIRE(doc->getMatchingPorts(constant->getName()).size() == 2);
+
+    // Remove elements from the document.
+    doc->removeNodeGraph(nodeGraph->getName());
+    REQUIRE(doc->getMatchingPorts(constant->getName()).size() == 1);
+    doc->removeNodeDef(nodeDef->getName());
+    REQUIRE(doc->getMatchingNodeDefs("custom2").empty());
+
+    // Compare the incrementally maintained cache with a freshly built one.
+    mx::DocumentPtr docCopy = doc->copy();
+    for (mx::NodeDefPtr elem : doc->getNodeDefs())
+    {
+        REQUIRE(doc->getMatchingNodeDefs(elem->getNodeString()).size() ==
+                docCopy->getMatchingNodeDefs(elem->getNodeString()).size());
+        REQUIRE(doc->getMatchingImplementations(elem->getName()).size() ==
+                docCopy->getMatchingImplementations(elem->getName()).size());
+    }
+    REQUIRE(doc->getMatchingPorts(constant->getName()).size() ==
+            docCopy->getMatchingPorts(constant->getName()).size());
+}
+
+TEST_CASE("Document cache threading", "[document]")
+{
+    const size_t THREAD_COUNT = 8;
+    const size_t LOOKUP_COUNT = 2000;
+
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibrary(mx::FilePath::getCurrentPath() / mx::FilePath("libraries/stdlib/stdlib_defs.mtlx"), doc);
+    mx::loadLibrary(mx::FilePath::getCurrentPath() / mx::FilePath("libraries/stdlib/stdlib_ng.mtlx"), doc);
+
+    // Record the expected lookup results from a single thread.
+    std::vector<mx::NodeDefPtr> nodeDefs = doc->getNodeDefs();
+    std::vector<size_t> expectedNodeDefs, expectedImpls;
+    for (mx::NodeDefPtr nodeDef : nodeDefs)
+    {
+        expectedNodeDefs.push_back(doc->getMatchingNodeDefs(nodeDef->getNodeString()).size());
+        expectedImpls.push_back(doc->getMatchingImplementations(nodeDef->getName()).size());
+    }
+
+    for (int round = 0; round < 2; round++)
+    {
+        // Edit the document between rounds, so that the first lookups of
+        // each round race to update the cache.
+        doc->addNodeDef("ND_round" + std::to_string(round), "float", "round");
+
+        std::atomic<size_t> mismatches(0);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < THREAD_COUNT; t++)
+        {
+            threads.emplace_back([&, t]()
+            {
+                for (size_t i = 0; i < LOOKUP_COUNT; i++)
+                {
+                    size_t index = (i * THREAD_COUNT + t) % nodeDefs.size();
+                    if (doc->getMatchingNodeDefs(nodeDefs[index]->getNodeString()).size() != expectedNodeDefs[index] ||
+                        doc->getMatchingImplementations(nodeDefs[index]->getName()).size() != expectedImpls[index])
+                    {
+                        mismatches++;
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        REQUIRE(mismatches == 0);
+        REQUIRE(doc->getMatchingNodeDefs("round").size() == (size_t) round + 1);
+    }
+}
+
+TEST_CASE("Document cache benchmark", "[document][benchmark][.]")
+{
+    const int EDIT_COUNT = 1000;
+    for (int nodeDefCount : { 1000, 10000, 100000 })
+    {
+        mx::DocumentPtr doc = mx::createDocument();
+        for (int i = 0; i < nodeDefCount; i++)
+        {
+            doc->addNodeDef("ND_node" + std::to_string(i), "float", "node" + std::to_string(i));
+        }
+        mx::NodeDefPtr nodeDef = doc->addNodeDef("ND_edited", "float", "edited");
+        REQUIRE(doc->getMatchingNodeDefs("edited").size() == 1);
+
+        // Interleave edits with lookups, as an interactive editor would.
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < EDIT_COUNT; i++)
+        {
+            nodeDef->setNodeString((i % 2) ? "edited" : "edited2");
+            REQUIRE(doc->getMatchingNodeDefs(nodeDef->getNodeString()).size() == 1);
+        }
+        std::chrono::duration<double, std::micro> duration = std::chrono::steady_clock::now() - start;
+
+        std::cout << "Document with " << nodeDefCount << " nodedefs: " <<
+            duration.count() / EDIT_COUNT << " us per edit and lookup" << std::endl;
+    }
+}
+
+TEST_CASE("Data library", "[document]")
+{
+    // Load the standard library into a shared library document.
+    mx::DocumentPtr stdlib = mx::createDocument();
+    mx::loadLibrary(mx::FilePath::getCurrentPath() / mx::FilePath("libraries/stdlib/stdlib_defs.mtlx"), stdlib);
+    mx::loadLibrary(mx::FilePath::getCurrentPath() / mx::FilePath("libraries/stdlib/stdlib_ng.mtlx"), stdlib);
+    mx::ConstDocumentPtr library = stdlib;
+
+    // Reference the library from a new document.
+    mx::DocumentPtr doc = mx::createDocument();
+    doc->setDataLibrary(library);
+    REQUIRE(doc->hasDataLibrary());
+    REQUIRE(doc->getNodeDefs().empty());
+
+    // Resolve library content through document lookups.
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+    mx::NodePtr add = nodeGraph->addNode("add", "add1", "float");
+    mx::OutputPtr output = nodeGraph->addOutput("out", "float");
+    output->setConnectedNode(add);
+    mx::NodeDefPtr nodeDef = add->getNodeDef();
+    REQUIRE(nodeDef);
+    REQUIRE(nodeDef->getDocument() == library);
+    REQUIRE(doc->getNodeDef(nodeDef->getName()) == nodeDef);
+    REQUIRE(doc->getMatchingNodeDefs("add").size() == library->getMatchingNodeDefs("add").size());
+    add->setNodeDefString(nodeDef->getName());
+    REQUIRE(add->getNodeDef() == nodeDef);
+    REQUIRE(doc->validate());
+    for (mx::NodeGraphPtr libraryGraph : library->getNodeGraphs())
+    {
+        if (libraryGraph->hasNodeDefString())
+        {
+            REQUIRE(doc->getNodeGraph(libraryGraph->getName()) == libraryGraph);
+            REQUIRE(doc->getMatchingImplementations(libraryGraph->getNodeDefString()).size() == 1);
+        }
+    }
+
+    // Local content takes precedence over library content.
+    mx::NodeDefPtr localNodeDef = doc->addNodeDef(nodeDef->getName(), "float", "add");
+    REQUIRE(doc->getNodeDef(nodeDef->getName()) == localNodeDef);
+    REQUIRE(doc->getMatchingNodeDefs("add")[0] == localNodeDef);
+    doc->removeNodeDef(localNodeDef->getName());
+
+    // Reference a namespaced library, which itself references the standard library.
+    mx::DocumentPtr customLibrary = mx::createDocument();
+    customLibrary->setNamespace("custom");
+    customLibrary->setDataLibrary(library);
+    mx::NodeDefPtr customNodeDef = customLibrary->addNodeDef("ND_simpleSrf", "surfaceshader", "simpleSrf");
+    doc->setDataLibrary(customLibrary);
+    mx::NodePtr custom = nodeGraph->addNode("custom:simpleSrf", "custom1", "surfaceshader");
+    REQUIRE(custom->getNodeDef() == customNodeDef);
+    REQUIRE(doc->getNodeDef("custom:ND_simpleSrf") == customNodeDef);
+    REQUIRE(add->getNodeDef() == nodeDef);
+    REQUIRE(doc->copy()->getDataLibrary() == customLibrary);
+
+    // Referenced libraries are frozen against further edits.
+    REQUIRE(stdlib->isFrozen());
+    REQUIRE(customLibrary->isFrozen());
+    REQUIRE(!doc->isFrozen());
+    mx::NodeDefPtr mutableNodeDef = stdlib->getNodeDef(nodeDef->getName());
+    REQUIRE_THROWS_AS(mutableNodeDef->setNodeString("subtract"), mx::Exception&);
+    REQUIRE_THROWS_AS(mutableNodeDef->addInput("extra", "float"), mx::Exception&);
+    REQUIRE_THROWS_AS(mutableNodeDef->removeChild(mutableNodeDef->getChildren()[0]->getName()), mx::Exception&);
+    REQUIRE_THROWS_AS(mutableNodeDef->setChildIndex(mutableNodeDef->getChildren()[0]->getName(), 1), mx::Exception&);
+    REQUIRE_THROWS_AS(stdlib->addNodeDef("ND_extra", "float", "extra"), mx::Exception&);
+    REQUIRE_THROWS_AS(customLibrary->setDataLibrary(nullptr), mx::Exception&);
+    REQUIRE(stdlib->getNodeDef(nodeDef->getName())->getNodeString() == "add");
+    mx::DocumentPtr libraryCopy = stdlib->copy();
+    REQUIRE(!libraryCopy->isFrozen());
+    libraryCopy->addNodeDef("ND_extra", "float", "extra");
+}
+
+TEST_CASE("Data library benchmark", "[document][benchmark][.]")
+{
+    const int DOCUMENT_COUNT = 100;
+    const mx::StringVec libraryFiles = { "libraries/stdlib/stdlib_defs.mtlx",
+                                         "libraries/stdlib/stdlib_ng.mtlx",
+                                         "libraries/pbrlib/pbrlib_defs.mtlx",
+                                         "libraries/pbrlib/pbrlib_ng.mtlx",
+                                         "libraries/bxdf/standard_surface.mtlx" };
+    mx::DocumentPtr library = mx::createDocument();
+    for (const std::string& file : libraryFiles)
+    {
+        mx::loadLibrary(mx::FilePath::getCurrentPath() / mx::FilePath(file), library);
+    }
+
+    for (bool referenced : { false, true })
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<mx::DocumentPtr> documents;
+        size_t documentElementCount = 0;
+        for (int i = 0; i < DOCUMENT_COUNT; i++)
+        {
+            mx::DocumentPtr doc = mx::createDocument();
+            if (referenced)
+            {
+                doc->setDataLibrary(library);
+            }
+            else
+            {
+                doc->importLibrary(library);
+            }
+            mx::NodePtr shader = doc->addNode("standard_surface", "shader1", "surfaceshader");
+            REQUIRE(shader->getNodeDef());
+            for (mx::ElementPtr elem : doc->traverseTree())
+            {
+                documentElementCount++;
+            }
+            documents.push_back(doc);
+        }
+        std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+
+        // Element counts are reported rather than heap sizes, with the elements
+        // of a referenced library counted once.
+        size_t libraryElementCount = 0;
+        if (referenced)
+        {
+            for (mx::ElementPtr elem : library->traverseTree())
+            {
+                libraryElementCount++;
+            }
+        }
+        std::cout << DOCUMENT_COUNT << " documents with " << (referenced ? "referenced" : "imported") <<
+            " library: " << documentElementCount << " document elements, " << libraryElementCount <<
+            " shared library elements, " << duration.count() << " ms" << std::endl;
+    }
+}
+
+TEST_CASE("Parallel validation", "[document]")
+{
+    const unsigned int THREAD_COUNT = 4;
+
+    mx::DocumentPtr doc = mx::createDocument();
+    for (const char* file : { "libraries/stdlib/stdlib_defs.mtlx",
+                              "libraries/stdlib/stdlib_ng.mtlx",
+                              "libraries/pbrlib/pbrlib_defs.mtlx",
+                              "libraries/pbrlib/pbrlib_ng.mtlx",
+                              "libraries/bxdf/standard_surface.mtlx" })
+    {
+        mx::loadLibrary(mx::FilePath::getCurrentPath() / mx::FilePath(file), doc);
+    }
+    mx::readFromXmlFile(doc, "resources/Materials/Examples/StandardSurface/standard_surface_brass_tiled.mtlx");
+    std::string message;
+    REQUIRE(doc->validate(&message));
+    REQUIRE(doc->validateParallel(&message, THREAD_COUNT));
+    REQUIRE(message.empty());
+
+    // Introduce errors across several top-level elements, which must be
+    // reported in document order.
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph("NG_invalid");
+    nodeGraph->setNodeDefString("ND_missing");
+    nodeGraph->addNode("add", "add1");
+    doc->getNodeDefs()[3]->setInheritString("ND_missing");
+    doc->getMaterials()[0]->addShaderRef("SR_invalid", "missing_shader");
+    doc->removeChild(doc->getChildren()[1]->getName());
+    std::string serialMessage, parallelMessage;
+    REQUIRE(!doc->validate(&serialMessage));
+    REQUIRE(!doc->validateParallel(&parallelMessage, THREAD_COUNT));
+    REQUIRE(!serialMessage.empty());
+    REQUIRE(parallelMessage == serialMessage);
+    REQUIRE(!doc->validateParallel());
+
+    // Validate a document referencing a data library.
+    mx::DocumentPtr libraryDoc = mx::createDocument();
+    libraryDoc->setDataLibrary(doc);
+    mx::NodeGraphPtr graph = libraryDoc->addNodeGraph();
+    graph->addOutput("out", "float")->setConnectedNode(graph->addNode("add", "add1", "float"));
+    libraryDoc->addNodeGraph()->addNode("missing_node", "node1", "float");
+    serialMessage.clear();
+    parallelMessage.clear();
+    REQUIRE(libraryDoc->validate(&serialMessage) == libraryDoc->validateParallel(&parallelMessage, THREAD_COUNT));
+    REQUIRE(parallelMessage == serialMessage);
+}
+
+TEST_CASE("Parallel validation benchmark", "[document][benchmark][.]")
+{
+    const int COPY_COUNT = 20;
+    const int ROUND_COUNT = 3;
+
+    // Build a large document from many copies of the data libraries.
+    mx::DocumentPtr library = mx::createDocument();
+    for (const char* file : { "libraries/stdlib/stdlib_defs.mtlx",
+                              "libraries/stdlib/stdlib_ng.mtlx",
+                              "libraries/pbrlib/pbrlib_defs.mtlx",
+                              "libraries/pbrlib/pbrlib_ng.mtlx",
+                              "libraries/bxdf/standard_surface.mtlx" })
+    {
+        mx::loadLibrary(mx::FilePath::getCurrentPath() / mx::FilePath(file), library);
+    }
+    mx::DocumentPtr doc = mx::createDocument();
+    doc->importLibrary(library);
+    for (int i = 0; i < COPY_COUNT; i++)
+    {
+        for (mx::NodeGraphPtr graph : library->getNodeGraphs())
+        {
+            mx::NodeGraphPtr graphCopy = doc->addNodeGraph(graph->getName() + "_copy" + std::to_string(i));
+            graphCopy->copyContentFrom(graph);
+        }
+    }
+
+    double serialTime = 0.0;
+    double parallelTime = 0.0;
+    for (int round = 0; round < ROUND_COUNT; round++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        REQUIRE(doc->validate());
+        auto serialEnd = std::chrono::steady_clock::now();
+        REQUIRE(doc->validateParallel());
+        auto parallelEnd = std::chrono::steady_clock::now();
+        serialTime += std::chrono::duration<double, std::milli>(serialEnd - start).count();
+        parallelTime += std::chrono::duration<double, std::milli>(parallelEnd - serialEnd).count();
+    }
+
+    std::cout << "Validation of " << doc->getChildren().size() << " top-level elements with " <<
+        std::thread::hardware_concurrency() << " hardware threads: " << serialTime / ROUND_COUNT << " ms serial, " <<
+        parallelTime / ROUND_COUNT << " ms parallel" << std::endl;
+}
+
 TEST_CASE("Version", "[document]")
 {
     mx::DocumentPtr doc = mx::createDocument();
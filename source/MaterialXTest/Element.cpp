@@ -6,6 +6,12 @@
 #include <MaterialXTest/Catch/catch.hpp>
 
 #include <MaterialXCore/Document.h>
+#include <MaterialXFormat/File.h>
+#include <MaterialXGenShader/Util.h>
+
+#include <chrono>
+#include <iostream>
+#include <thread>
 
 namespace mx = MaterialX;
 
@@ -40,6 +46,24 @@ TEST_CASE("Element", "[element]")
     REQUIRE(elem1->getTypedAttribute<bool>("customColor") == false);
     REQUIRE(elem1->getTypedAttribute<mx::Color3>("customFlag") == mx::Color3(0.0f));
 
+    // Attributes maintain the order in which they were first set.
+    elem2->setAttribute("attrA", "a");
+    elem2->setAttribute("attrB", "b");
+    elem2->setAttribute("attrC", "c");
+    elem2->setAttribute("attrA", "a2");
+    REQUIRE(elem2->getAttributeNames() == mx::StringVec({ "attrA", "attrB", "attrC" }));
+    REQUIRE(elem2->getAttribute("attrA") == "a2");
+    elem2->removeAttribute("attrB");
+    REQUIRE(!elem2->hasAttribute("attrB"));
+    REQUIRE(elem2->getAttribute("attrB").empty());
+    elem2->setAttribute("attrB", "b2");
+    REQUIRE(elem2->getAttributeNames() == mx::StringVec({ "attrA", "attrC", "attrB" }));
+    for (const char* attr : { "attrA", "attrB", "attrC" })
+    {
+        elem2->removeAttribute(attr);
+    }
+    REQUIRE(elem2->getAttributeNames().empty());
+
     // Modify element names.
     elem1->setName("elem1");
     elem2->setName("elem2");
@@ -66,3 +90,234 @@ TEST_CASE("Element", "[element]")
     }
     REQUIRE_THROWS_AS(orphan->getDocument(), mx::ExceptionOrphanedElement&);    
 }
+
+TEST_CASE("Child order", "[element]")
+{
+    // Apply interleaved removals and reorderings, comparing the resulting
+    // child order against a reference vector of names.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+    std::vector<std::string> reference;
+    for (int i = 0; i < 100; i++)
+    {
+        std::string name = "node" + std::to_string(i);
+        nodeGraph->addNode("constant", name);
+        reference.push_back(name);
+    }
+    for (int i = 0; i < 40; i++)
+    {
+        size_t removeIndex = (i * 7) % reference.size();
+        nodeGraph->removeChild(reference[removeIndex]);
+        reference.erase(reference.begin() + removeIndex);
+
+        size_t oldIndex = (i * 13) % reference.size();
+        size_t newIndex = (i * 29) % reference.size();
+        std::string moved = reference[oldIndex];
+        nodeGraph->setChildIndex(moved, (int) newIndex);
+        reference.erase(reference.begin() + oldIndex);
+        reference.insert(reference.begin() + newIndex, moved);
+
+        if (i % 5 == 0)
+        {
+            nodeGraph->addNode("constant", "extra" + std::to_string(i));
+            reference.push_back("extra" + std::to_string(i));
+        }
+    }
+
+    const std::vector<mx::ElementPtr>& children = nodeGraph->getChildren();
+    REQUIRE(children.size() == reference.size());
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        REQUIRE(children[i]->getName() == reference[i]);
+        REQUIRE(nodeGraph->getChildIndex(reference[i]) == (int) i);
+    }
+    REQUIRE(nodeGraph->getChildIndex("node0") == -1);
+    REQUIRE_THROWS_AS(nodeGraph->setChildIndex(reference[0], (int) reference.size() + 1), mx::Exception&);
+
+    // Removals within a single update scope are applied together, while
+    // remaining visible to queries within the scope.
+    {
+        mx::ScopedUpdate update(doc);
+        for (size_t i = 0; i < reference.size(); i += 2)
+        {
+            nodeGraph->removeChild(reference[i]);
+        }
+        reference.erase(std::remove_if(reference.begin(), reference.end(),
+            [&nodeGraph](const std::string& name) { return !nodeGraph->getChild(name); }), reference.end());
+        REQUIRE(nodeGraph->getChildren().size() == reference.size());
+        nodeGraph->removeChild(reference.back());
+        reference.pop_back();
+    }
+    REQUIRE(nodeGraph->getChildren().size() == reference.size());
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        REQUIRE(nodeGraph->getChildren()[i]->getName() == reference[i]);
+        REQUIRE(nodeGraph->getChildIndex(reference[i]) == (int) i);
+    }
+
+    // Copies preserve the child order.
+    mx::DocumentPtr doc2 = doc->copy();
+    REQUIRE(*doc2 == *doc);
+}
+
+TEST_CASE("Interned strings", "[element]")
+{
+    // Interned strings are shared by address.
+    const std::string& interned = mx::internString("customCategory");
+    REQUIRE(interned == "customCategory");
+    REQUIRE(&mx::internString(std::string("custom") + "Category") == &interned);
+    REQUIRE(mx::findInternedString("customCategory") == &interned);
+    REQUIRE(!mx::findInternedString("neverInternedCategory"));
+
+    // Strings interned concurrently from several threads share one address.
+    const int THREAD_COUNT = 4;
+    const int STRING_COUNT = 1000;
+    std::vector<std::vector<const std::string*>> threadResults(THREAD_COUNT);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREAD_COUNT; t++)
+    {
+        threads.emplace_back([t, &threadResults]()
+        {
+            for (int i = 0; i < STRING_COUNT; i++)
+            {
+                threadResults[t].push_back(&mx::internString("concurrentString" + std::to_string(i)));
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    for (int i = 0; i < STRING_COUNT; i++)
+    {
+        const std::string* expected = mx::findInternedString("concurrentString" + std::to_string(i));
+        REQUIRE(expected);
+        for (int t = 0; t < THREAD_COUNT; t++)
+        {
+            REQUIRE(threadResults[t][i] == expected);
+        }
+    }
+
+    // Element categories and attribute names are interned.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::DocumentPtr doc2 = mx::createDocument();
+    mx::ElementPtr elem1 = doc->addChildOfCategory("customCategory", "elem");
+    mx::ElementPtr elem2 = doc2->addChildOfCategory("customCategory", "elem");
+    REQUIRE(&elem1->getCategory() == &interned);
+    REQUIRE(&elem2->getCategory() == &interned);
+    elem1->setAttribute("customAttribute", "value1");
+    elem2->setAttribute("customAttribute", "value2");
+    REQUIRE(mx::findInternedString("customAttribute"));
+    REQUIRE(elem1->getAttributeNames() == elem2->getAttributeNames());
+    REQUIRE(*elem1 != *elem2);
+    elem2->setAttribute("customAttribute", "value1");
+    REQUIRE(*elem1 == *elem2);
+
+    // Category-filtered queries match interned categories.
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+    nodeGraph->addNode("constant", "node1");
+    nodeGraph->addNode("image", "node2");
+    REQUIRE(nodeGraph->getChildrenOfType<mx::Node>("constant").size() == 1);
+    REQUIRE(nodeGraph->getChildrenOfType<mx::Node>("neverInternedCategory").empty());
+    REQUIRE(nodeGraph->getNode("node2")->isA<mx::Node>("image"));
+    REQUIRE(!nodeGraph->getNode("node2")->isA<mx::Node>("constant"));
+    nodeGraph->getNode("node2")->setCategory("constant");
+    REQUIRE(nodeGraph->getChildrenOfType<mx::Node>("constant").size() == 2);
+}
+
+TEST_CASE("Interned strings benchmark", "[element][benchmark][.]")
+{
+    const int ROUND_COUNT = 20;
+
+    // Import the full data library into a single document.
+    mx::DocumentPtr doc = mx::createDocument();
+    for (const char* file : { "libraries/stdlib/stdlib_defs.mtlx",
+                              "libraries/stdlib/stdlib_ng.mtlx",
+                              "libraries/pbrlib/pbrlib_defs.mtlx",
+                              "libraries/pbrlib/pbrlib_ng.mtlx",
+                              "libraries/bxdf/standard_surface.mtlx" })
+    {
+        mx::loadLibrary(mx::FilePath::getCurrentPath() / mx::FilePath(file), doc);
+    }
+
+    size_t elementCount = 0;
+    size_t attributeCount = 0;
+    for (mx::ElementPtr elem : doc->traverseTree())
+    {
+        elementCount++;
+        attributeCount += elem->getAttributeNames().size();
+    }
+    std::cout << elementCount << " elements, " << attributeCount << " attributes, " <<
+        sizeof(mx::Element) << " bytes per Element" << std::endl;
+
+    // Traverse the document with category-filtered queries.
+    size_t matchCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUND_COUNT; round++)
+    {
+        for (mx::ElementPtr elem : doc->traverseTree())
+        {
+            if (elem->isA<mx::ValueElement>(mx::Input::CATEGORY))
+            {
+                matchCount++;
+            }
+        }
+        for (mx::NodeDefPtr nodeDef : doc->getChildrenOfType<mx::NodeDef>(mx::NodeDef::CATEGORY))
+        {
+            matchCount += nodeDef->getChildrenOfType<mx::ValueElement>(mx::Parameter::CATEGORY).size();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Category-filtered traversal: " <<
+        std::chrono::duration<double, std::milli>(end - start).count() / ROUND_COUNT << " ms per round, " <<
+        matchCount / ROUND_COUNT << " matches" << std::endl;
+}
+
+TEST_CASE("Child removal benchmark", "[element][benchmark][.]")
+{
+    for (int childCount : { 10000, 30000, 100000 })
+    {
+        for (bool batched : { true, false })
+        {
+            mx::DocumentPtr doc = mx::createDocument();
+            mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+            for (int i = 0; i < childCount; i++)
+            {
+                nodeGraph->addNode("constant", "node" + std::to_string(i));
+            }
+
+            // Remove every other child, either within a single update scope
+            // or with each removal applied individually.
+            auto start = std::chrono::steady_clock::now();
+            {
+                std::unique_ptr<mx::ScopedUpdate> update(batched ? new mx::ScopedUpdate(doc) : nullptr);
+                for (int i = 0; i < childCount; i += 2)
+                {
+                    nodeGraph->removeChild("node" + std::to_string(i));
+                }
+            }
+            auto removed = std::chrono::steady_clock::now();
+            int indexSum = 0;
+            for (int i = 1; i < childCount; i += 2)
+            {
+                indexSum += nodeGraph->getChildIndex("node" + std::to_string(i));
+            }
+            auto queried = std::chrono::steady_clock::now();
+
+            // Move children from the back to the front.
+            const int moveCount = 1000;
+            for (int i = 0; i < moveCount; i++)
+            {
+                nodeGraph->setChildIndex(nodeGraph->getChildren().back()->getName(), 0);
+            }
+            auto moved = std::chrono::steady_clock::now();
+
+            std::cout << childCount << " children: " <<
+                std::chrono::duration<double, std::milli>(removed - start).count() << " ms to remove " << childCount / 2 <<
+                (batched ? " in one update, " : " individually, ") <<
+                std::chrono::duration<double, std::milli>(queried - removed).count() << " ms to index " << childCount / 2 << ", " <<
+                std::chrono::duration<double, std::milli>(moved - queried).count() << " ms to move " << moveCount <<
+                " (index sum " << indexSum << ")" << std::endl;
+        }
+    }
+}
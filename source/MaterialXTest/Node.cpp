@@ -11,6 +11,9 @@
 #include <MaterialXFormat/File.h>
 #include <MaterialXFormat/XmlIo.h>
 
+#include <chrono>
+#include <iostream>
+
 namespace mx = MaterialX;
 
 bool isTopologicalOrder(const std::vector<mx::ElementPtr>& elems)
@@ -135,6 +138,148 @@ TEST_CASE("Node", "[node]")
     REQUIRE(doc->getOutputs().empty());
 }
 
+TEST_CASE("Active interface elements", "[node]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+
+    // Create a base nodedef and an inherited nodedef.
+    mx::NodeDefPtr base = doc->addNodeDef("ND_base", "color3", "base");
+    mx::InputPtr baseInputA = base->addInput("a", "color3");
+    base->addInput("b", "color3");
+    mx::ParameterPtr baseParam = base->addParameter("p", "float");
+    base->addToken("t");
+    mx::NodeDefPtr derived = doc->addNodeDef("ND_derived", "color3", "derived");
+    mx::InputPtr derivedInputB = derived->addInput("b", "color3");
+    mx::InputPtr derivedInputC = derived->addInput("c", "color3");
+    mx::ParameterPtr derivedParam = derived->addParameter("p", "float");
+    derived->setInheritsFrom(base);
+
+    // Query the active elements of the inherited nodedef.
+    std::vector<mx::InputPtr> inputs = derived->getActiveInputs();
+    REQUIRE(inputs == std::vector<mx::InputPtr>({ derivedInputB, derivedInputC, baseInputA }));
+    REQUIRE(derived->getActiveParameters() == std::vector<mx::ParameterPtr>({ derivedParam, baseParam }));
+    REQUIRE(derived->getActiveOutputs().size() == 1);
+    REQUIRE(derived->getActiveTokens().size() == 1);
+    REQUIRE(derived->getActiveValueElements().size() == 6);
+    REQUIRE(derived->getActiveInput("a") == baseInputA);
+    REQUIRE(derived->getActiveInput("b") == derivedInputB);
+    REQUIRE(derived->getActiveParameter("p") == derivedParam);
+    REQUIRE(derived->getActiveToken("t") == base->getToken("t"));
+    REQUIRE(derived->getActiveOutput("out") == derived->getOutput("out"));
+    REQUIRE(derived->getActiveValueElement("missing") == nullptr);
+
+    // Repeated queries return the same resolution.
+    REQUIRE(derived->getActiveInputs() == inputs);
+
+    // Edits while iterating over active elements leave the iterated vector
+    // intact.
+    for (mx::InputPtr input : derived->getActiveInputs())
+    {
+        derived->addInput(input->getName() + "_copy", "color3");
+        base->addParameter(input->getName() + "_param", "float");
+    }
+    REQUIRE(derived->getActiveInputs().size() == 2 * inputs.size());
+    for (mx::InputPtr input : inputs)
+    {
+        derived->removeInput(input->getName() + "_copy");
+        base->removeParameter(input->getName() + "_param");
+    }
+    REQUIRE(derived->getActiveInputs() == inputs);
+
+    // Edits to the document invalidate the cached resolution.
+    uint64_t revision = doc->getRevision();
+    mx::InputPtr baseInputD = base->addInput("d", "color3");
+    REQUIRE(doc->getRevision() > revision);
+    REQUIRE(derived->getActiveInputs().size() == 4);
+    REQUIRE(derived->getActiveInput("d") == baseInputD);
+    base->removeInput("a");
+    REQUIRE(derived->getActiveInputs().size() == 3);
+    REQUIRE(derived->getActiveInput("a") == nullptr);
+    derived->setInheritsFrom(nullptr);
+    REQUIRE(derived->getActiveInputs().size() == 2);
+    REQUIRE(derived->getActiveInput("d") == nullptr);
+
+    // Reordering children invalidates the cached resolution.
+    REQUIRE(derived->getActiveInputs() == std::vector<mx::InputPtr>({ derivedInputB, derivedInputC }));
+    revision = doc->getRevision();
+    derived->setChildIndex("c", 0);
+    REQUIRE(doc->getRevision() > revision);
+    REQUIRE(derived->getActiveInputs() == std::vector<mx::InputPtr>({ derivedInputC, derivedInputB }));
+    derived->setChildIndex("b", 0);
+    REQUIRE(derived->getActiveInputs() == std::vector<mx::InputPtr>({ derivedInputB, derivedInputC }));
+
+    // Inherit from a nodedef in a referenced data library.
+    mx::DocumentPtr library = mx::createDocument();
+    mx::NodeDefPtr libraryBase = library->addNodeDef("ND_libraryBase", "color3", "libraryBase");
+    libraryBase->addInput("e", "color3");
+    doc->setDataLibrary(library);
+    derived->setInheritString(libraryBase->getName());
+    REQUIRE(derived->getActiveInputs().size() == 3);
+    revision = doc->getRevision();
+    mx::DocumentPtr updatedLibrary = library->copy();
+    mx::NodeDefPtr updatedBase = updatedLibrary->getNodeDef(libraryBase->getName());
+    updatedBase->addInput("f", "color3");
+    doc->setDataLibrary(updatedLibrary);
+    REQUIRE(doc->getRevision() > revision);
+    REQUIRE(derived->getActiveInputs().size() == 4);
+    REQUIRE(derived->getActiveInput("f") == updatedBase->getInput("f"));
+    doc->setDataLibrary(nullptr);
+    REQUIRE(derived->getActiveInputs().size() == 2);
+
+    // Inheritance cycles are reported on each query.
+    derived->setInheritsFrom(base);
+    base->setInheritsFrom(derived);
+    REQUIRE_THROWS_AS(derived->getActiveInputs(), mx::ExceptionFoundCycle&);
+    REQUIRE_THROWS_AS(derived->getActiveInputs(), mx::ExceptionFoundCycle&);
+    base->setInheritsFrom(nullptr);
+    REQUIRE(derived->getActiveInputs().size() == 3);
+}
+
+TEST_CASE("Active interface benchmark", "[node][benchmark][.]")
+{
+    const int ROUND_COUNT = 10000;
+
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::readFromXmlFile(doc, "libraries/bxdf/standard_surface.mtlx");
+    mx::NodeDefPtr nodeDef = doc->getNodeDef("ND_standard_surface_surfaceshader");
+    REQUIRE(nodeDef);
+
+    // Resolve the active inputs by traversing the inheritance chain on each
+    // query, as a baseline for the cached resolution.
+    size_t uncachedCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUND_COUNT; round++)
+    {
+        std::vector<mx::InputPtr> activeInputs;
+        mx::StringSet activeInputNames;
+        for (mx::ConstElementPtr elem : nodeDef->traverseInheritance())
+        {
+            for (const mx::InputPtr& input : elem->asA<mx::InterfaceElement>()->getInputs())
+            {
+                if (activeInputNames.insert(input->getName()).second)
+                {
+                    activeInputs.push_back(input);
+                }
+            }
+        }
+        uncachedCount += activeInputs.size();
+    }
+    auto uncachedEnd = std::chrono::steady_clock::now();
+
+    size_t cachedCount = 0;
+    for (int round = 0; round < ROUND_COUNT; round++)
+    {
+        cachedCount += nodeDef->getActiveInputs().size();
+    }
+    auto cachedEnd = std::chrono::steady_clock::now();
+    REQUIRE(cachedCount == uncachedCount);
+
+    double uncachedTime = std::chrono::duration<double, std::micro>(uncachedEnd - start).count() / ROUND_COUNT;
+    double cachedTime = std::chrono::duration<double, std::micro>(cachedEnd - uncachedEnd).count() / ROUND_COUNT;
+    std::cout << nodeDef->getName() << " active inputs: " <<
+        uncachedTime << " us uncached, " << cachedTime << " us cached" << std::endl;
+}
+
 TEST_CASE("Flatten", "[nodegraph]")
 {
     mx::FileSearchPath searchPath = "resources/Materials/Examples/Syntax" +
@@ -103,3 +103,41 @@ TEST_CASE("Print utilities", "[util]")
 
     REQUIRE(nodeGraph->asStringDot() == blessed);
 }
+
+TEST_CASE("Parallel tasks", "[util]")
+{
+    REQUIRE(mx::getWorkerThreadCount(4, 100) == 4);
+    REQUIRE(mx::getWorkerThreadCount(4, 2) == 2);
+    REQUIRE(mx::getWorkerThreadCount(0, 100) >= 1);
+
+    // Each task runs once, on a valid worker.
+    for (unsigned int threadCount : { 1u, 4u })
+    {
+        std::vector<int> counts(1000, 0);
+        std::vector<char> validWorkers(counts.size(), 0);
+        mx::runParallelTasks(counts.size(), threadCount, [&](size_t index, unsigned int worker)
+        {
+            counts[index]++;
+            validWorkers[index] = worker < threadCount;
+        });
+        REQUIRE(counts == std::vector<int>(counts.size(), 1));
+        REQUIRE(validWorkers == std::vector<char>(counts.size(), 1));
+
+        // The exception of the earliest failing task is reported.
+        try
+        {
+            mx::runParallelTasks(counts.size(), threadCount, [](size_t index, unsigned int)
+            {
+                if (index % 100 == 50)
+                {
+                    throw mx::Exception("Task " + std::to_string(index));
+                }
+            });
+            FAIL("Expected an exception");
+        }
+        catch (mx::Exception& e)
+        {
+            REQUIRE(std::string(e.what()) == "Task 50");
+        }
+    }
+}
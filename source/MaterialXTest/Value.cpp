@@ -8,6 +8,9 @@
 #include <MaterialXCore/Util.h>
 #include <MaterialXCore/Value.h>
 
+#include <chrono>
+#include <iostream>
+
 namespace mx = MaterialX;
 
 template<class T> void testTypedValue(const T& v1, const T& v2)
@@ -80,6 +83,95 @@ TEST_CASE("Value strings", "[value]")
     REQUIRE_THROWS_AS(mx::fromValueString<mx::Color3>("1"), mx::ExceptionTypeError&);
 }
 
+TEST_CASE("Value parsing", "[value]")
+{
+    // Parse numeric values with the conventions of stream extraction.
+    REQUIRE(mx::fromValueString<int>(" -12") == -12);
+    REQUIRE(mx::fromValueString<int>("+7") == 7);
+    REQUIRE(mx::fromValueString<int>("2147483647") == 2147483647);
+    REQUIRE(mx::fromValueString<float>("-.5") == -0.5f);
+    REQUIRE(mx::fromValueString<float>("1.e2") == 100.0f);
+    REQUIRE(mx::fromValueString<float>("2.5E-3") == 0.0025f);
+    REQUIRE(mx::fromValueString<float>("1e-50") == 0.0f);
+    REQUIRE(mx::fromValueString<double>("0.1") == 0.1);
+    REQUIRE(mx::fromValueString<double>("1.00000000000000000000001") == 1.0);
+    REQUIRE(mx::fromValueString<mx::Color3>("0.1,0.2 0.3") == mx::Color3(0.1f, 0.2f, 0.3f));
+    REQUIRE(mx::fromValueString<mx::Matrix33>("1, 2, 3, 4, 5, 6, 7, 8, 9")[1][0] == 4.0f);
+    REQUIRE_THROWS_AS(mx::fromValueString<int>("2147483648"), mx::ExceptionTypeError&);
+    REQUIRE_THROWS_AS(mx::fromValueString<float>("1e"), mx::ExceptionTypeError&);
+    REQUIRE_THROWS_AS(mx::fromValueString<float>("1e400"), mx::ExceptionTypeError&);
+    REQUIRE_THROWS_AS(mx::fromValueString<float>("-"), mx::ExceptionTypeError&);
+    REQUIRE_THROWS_AS(mx::fromValueString<mx::Vector2>("1, 2, 3"), mx::ExceptionTypeError&);
+    REQUIRE_THROWS_AS(mx::fromValueString<mx::FloatVec>("1, x"), mx::ExceptionTypeError&);
+
+    // Verify that floats survive a round trip at full precision.
+    mx::ScopedFloatFormatting fmt(mx::Value::FloatFormatDefault, 9);
+    for (float value = 1.0e-6f; value < 1.0e6f; value *= 1.0001f)
+    {
+        REQUIRE(mx::fromValueString<float>(mx::toValueString(value)) == value);
+        REQUIRE(mx::fromValueString<float>(mx::toValueString(-value)) == -value);
+    }
+
+    // Parse float arrays in bulk.
+    mx::FloatVec floats;
+    mx::parseFloatArray("0.5, 1, 2.5e1 3", floats);
+    mx::parseFloatArray("4", floats);
+    REQUIRE(floats == mx::FloatVec({ 0.5f, 1.0f, 25.0f, 3.0f, 4.0f }));
+    REQUIRE_THROWS_AS(mx::parseFloatArray("1, text", floats), mx::ExceptionTypeError&);
+}
+
+TEST_CASE("Value parsing benchmark", "[value][benchmark][.]")
+{
+    const int VALUE_COUNT = 100000;
+    const std::vector<std::pair<std::string, std::string>> typedStrings =
+    {
+        { "integer", "-12345" },
+        { "boolean", "true" },
+        { "float", "0.123456791" },
+        { "color2", "0.18, 0.5" },
+        { "color3", "0.8, 0.8, 0.8" },
+        { "color4", "0.25, 0.5, 0.75, 1.0" },
+        { "vector2", "1.5, -2.5" },
+        { "vector3", "0.577350259, 0.577350259, 0.577350259" },
+        { "vector4", "1.0, 0.0, 0.0, 1.0" },
+        { "matrix33", "1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0" },
+        { "matrix44", "0.707106769, -0.707106769, 0.0, 0.0, 0.707106769, 0.707106769, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 12.5, -3.25, 100.0, 1.0" },
+        { "string", "text" },
+        { "integerarray", "1, 2, 3, 4, 5, 6, 7, 8" },
+        { "booleanarray", "true, false, true, false" },
+        { "floatarray", "0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8" },
+        { "stringarray", "one, two, three" }
+    };
+
+    for (const auto& pair : typedStrings)
+    {
+        int parsedCount = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < VALUE_COUNT; i++)
+        {
+            parsedCount += (mx::Value::createValueFromStrings(pair.second, pair.first) != nullptr);
+        }
+        auto end = std::chrono::steady_clock::now();
+        REQUIRE(parsedCount == VALUE_COUNT);
+        double time = std::chrono::duration<double, std::nano>(end - start).count() / VALUE_COUNT;
+        std::cout << pair.first << ": " << time << " ns per value" << std::endl;
+    }
+
+    // Parse a large float array in bulk.
+    std::string floatArray;
+    for (int i = 0; i < VALUE_COUNT; i++)
+    {
+        floatArray += std::to_string(i * 0.001f) + ", ";
+    }
+    mx::FloatVec floats;
+    auto start = std::chrono::steady_clock::now();
+    mx::parseFloatArray(floatArray, floats);
+    auto end = std::chrono::steady_clock::now();
+    REQUIRE(floats.size() == VALUE_COUNT);
+    std::cout << "parseFloatArray: " << std::chrono::duration<double, std::milli>(end - start).count() <<
+        " ms for " << VALUE_COUNT << " values" << std::endl;
+}
+
 TEST_CASE("Typed values", "[value]")
 {
     // Base types
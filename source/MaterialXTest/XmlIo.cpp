@@ -5,12 +5,24 @@
 
 #include <MaterialXTest/Catch/catch.hpp>
 
+#include <MaterialXTest/XmlIoUtil.h>
+
+#include <MaterialXCore/Observer.h>
+
 #include <MaterialXFormat/Environ.h>
 #include <MaterialXFormat/File.h>
 #include <MaterialXFormat/XmlIo.h>
 
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
 namespace mx = MaterialX;
 
+using XmlIoUtil::getDocumentsInTree;
+using XmlIoUtil::getXIncludeDocument;
+
 TEST_CASE("Load content", "[xmlio]")
 {
     mx::FilePath libraryPath("libraries/stdlib");
@@ -247,3 +259,439 @@ TEST_CASE("Load content", "[xmlio]")
         "resources/Materials/TestSuite/libraries/metal/brass_wire_mesh.mtlx", searchPath);
     REQUIRE(nullptr != parentDoc->getNodeDef("ND_TestMetal"));
 }
+
+TEST_CASE("Parallel XIncludes", "[xmlio]")
+{
+    // Read all data libraries through XIncludes, serially and in parallel.
+    mx::FilePathVec files = getDocumentsInTree("libraries");
+    REQUIRE(files.size() > 1);
+    std::string xml = getXIncludeDocument(files);
+    mx::DocumentPtr serialDoc = mx::createDocument();
+    mx::readFromXmlString(serialDoc, xml);
+
+    // Use an explicit thread count, so that worker threads are exercised
+    // regardless of the number of hardware threads.
+    for (unsigned int threadCount : { 0u, 1u, 4u })
+    {
+        mx::XmlReadOptions readOptions;
+        readOptions.parallelXIncludes = true;
+        readOptions.threadCount = threadCount;
+        mx::DocumentPtr parallelDoc = mx::createDocument();
+        mx::readFromXmlString(parallelDoc, xml, &readOptions);
+        REQUIRE(!parallelDoc->getChildren().empty());
+        REQUIRE(*parallelDoc == *serialDoc);
+
+        // Verify that the earliest error in document order is reported.
+        mx::FilePathVec missingFiles = files;
+        missingFiles.insert(missingFiles.begin() + 1, mx::FilePath("NonExistent.mtlx"));
+        mx::DocumentPtr missingDoc = mx::createDocument();
+        REQUIRE_THROWS_AS(mx::readFromXmlString(missingDoc, getXIncludeDocument(missingFiles), &readOptions),
+                          mx::ExceptionFileMissing&);
+        readOptions.parentXIncludes.push_back(files[1].asString(mx::FilePath::FormatPosix));
+        mx::DocumentPtr cycleDoc = mx::createDocument();
+        REQUIRE_THROWS_AS(mx::readFromXmlString(cycleDoc, getXIncludeDocument(missingFiles), &readOptions),
+                          mx::ExceptionFileMissing&);
+        REQUIRE_THROWS_AS(mx::readFromXmlString(cycleDoc, xml, &readOptions), mx::ExceptionParseError&);
+    }
+}
+
+TEST_CASE("Parallel XIncludes benchmark", "[xmlio][benchmark][.]")
+{
+    const int ROUND_COUNT = 10;
+    mx::FilePathVec files = getDocumentsInTree("libraries");
+    std::string xml = getXIncludeDocument(files);
+
+    for (unsigned int threadCount : { 1u, 2u, 4u })
+    {
+        mx::XmlReadOptions readOptions;
+        readOptions.parallelXIncludes = true;
+        readOptions.threadCount = threadCount;
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < ROUND_COUNT; round++)
+        {
+            mx::DocumentPtr doc = mx::createDocument();
+            mx::readFromXmlString(doc, xml, &readOptions);
+        }
+        auto end = std::chrono::steady_clock::now();
+        std::cout << files.size() << " library files read on " << threadCount << " threads (" <<
+            std::thread::hardware_concurrency() << " hardware threads): " <<
+            std::chrono::duration<double, std::milli>(end - start).count() / ROUND_COUNT << " ms" << std::endl;
+    }
+}
+
+TEST_CASE("XInclude cache", "[xmlio]")
+{
+    // Read documents with and without a cache, including a nested XInclude.
+    mx::FilePathVec files = { "libraries/stdlib/stdlib_defs.mtlx",
+                              "libraries/pbrlib/pbrlib_defs.mtlx",
+                              "resources/Materials/TestSuite/libraries/metal/brass_wire_mesh.mtlx" };
+    std::string xml = getXIncludeDocument(files);
+    mx::DocumentPtr uncachedDoc = mx::createDocument();
+    mx::readFromXmlString(uncachedDoc, xml);
+
+    mx::XmlReadOptions readOptions;
+    readOptions.xincludeCache = mx::XIncludeCache::create();
+    for (int i = 0; i < 3; i++)
+    {
+        mx::DocumentPtr cachedDoc = mx::createDocument();
+        mx::readFromXmlString(cachedDoc, xml, &readOptions);
+        REQUIRE(*cachedDoc == *uncachedDoc);
+    }
+    REQUIRE(readOptions.xincludeCache->getDocumentCount() == files.size());
+    REQUIRE(readOptions.xincludeCache->getMissCount() == files.size());
+    REQUIRE(readOptions.xincludeCache->getHitCount() == files.size() * 2);
+
+    // Verify that a modified nested include invalidates its cached parent.
+    const std::string nestedXml = "<?xml version=\"1.0\"?>\n<materialx version=\"1.37\">\n"
+                                  "  <nodedef name=\"ND_cache_test\" node=\"cache_test\">\n"
+                                  "    <output name=\"out\" type=\"%\" />\n  </nodedef>\n</materialx>\n";
+    auto writeNestedFile = [&nestedXml](const std::string& type)
+    {
+        std::string content = nestedXml;
+        content.replace(content.find('%'), 1, type);
+        std::ofstream("cache_test_nested.mtlx") << content;
+    };
+    writeNestedFile("float");
+    std::ofstream("cache_test_parent.mtlx") << getXIncludeDocument({ mx::FilePath("cache_test_nested.mtlx") });
+    std::string parentXml = getXIncludeDocument({ mx::FilePath("cache_test_parent.mtlx") });
+
+    readOptions.xincludeCache->clear();
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::readFromXmlString(doc, parentXml, &readOptions);
+    REQUIRE(doc->getNodeDef("ND_cache_test")->getType() == "float");
+
+    int64_t previousTime = mx::FilePath("cache_test_nested.mtlx").getModificationTime();
+    while (mx::FilePath("cache_test_nested.mtlx").getModificationTime() == previousTime)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        writeNestedFile("color3");
+    }
+    doc = mx::createDocument();
+    mx::readFromXmlString(doc, parentXml, &readOptions);
+    REQUIRE(doc->getNodeDef("ND_cache_test")->getType() == "color3");
+    REQUIRE(readOptions.xincludeCache->getHitCount() == 0);
+    REQUIRE(readOptions.xincludeCache->getMissCount() == 2);
+
+    std::remove("cache_test_nested.mtlx");
+    std::remove("cache_test_parent.mtlx");
+}
+
+TEST_CASE("XInclude cache benchmark", "[xmlio][benchmark][.]")
+{
+    // Read each TestSuite material along with XIncludes of its libraries.
+    mx::FilePathVec libraryFiles = { "libraries/stdlib/stdlib_defs.mtlx",
+                                     "libraries/stdlib/stdlib_ng.mtlx",
+                                     "libraries/pbrlib/pbrlib_defs.mtlx",
+                                     "libraries/pbrlib/pbrlib_ng.mtlx",
+                                     "libraries/bxdf/standard_surface.mtlx" };
+    mx::FilePathVec materialFiles = getDocumentsInTree("resources/Materials/TestSuite");
+
+    for (bool cached : { false, true })
+    {
+        mx::XmlReadOptions readOptions;
+        readOptions.skipConflictingElements = true;
+        if (cached)
+        {
+            readOptions.xincludeCache = mx::XIncludeCache::create();
+        }
+
+        size_t documentCount = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const mx::FilePath& materialFile : materialFiles)
+        {
+            mx::FilePathVec files = libraryFiles;
+            files.push_back(materialFile);
+            mx::DocumentPtr doc = mx::createDocument();
+            try
+            {
+                mx::readFromXmlString(doc, getXIncludeDocument(files), &readOptions);
+            }
+            catch (mx::Exception&)
+            {
+                continue;
+            }
+            documentCount++;
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << documentCount << " TestSuite documents read " << (cached ? "with" : "without") << " XInclude cache: " <<
+            std::chrono::duration<double, std::milli>(end - start).count() << " ms";
+        if (cached)
+        {
+            std::cout << " (" << readOptions.xincludeCache->getHitCount() << " hits, " <<
+                readOptions.xincludeCache->getMissCount() << " misses)";
+        }
+        std::cout << std::endl;
+    }
+}
+
+TEST_CASE("Deferred library elements", "[xmlio]")
+{
+    // Read all data libraries through XIncludes, with and without deferred
+    // library elements.
+    std::string xml = getXIncludeDocument(getDocumentsInTree("libraries"));
+    mx::DocumentPtr eagerDoc = mx::createDocument();
+    mx::readFromXmlString(eagerDoc, xml);
+    mx::XmlReadOptions readOptions;
+    readOptions.deferLibraryElements = true;
+    mx::DocumentPtr lazyDoc = mx::createDocument();
+    mx::readFromXmlString(lazyDoc, xml, &readOptions);
+    REQUIRE(lazyDoc->getDeferredElementCount() > 0);
+    REQUIRE(lazyDoc->getChildren().size() + lazyDoc->getDeferredElementCount() == eagerDoc->getChildren().size());
+    REQUIRE(lazyDoc->getChildrenOfType<mx::NodeDef>().empty());
+    REQUIRE(!lazyDoc->getTypeDefs().empty());
+
+    // Deferred elements are loaded as they are resolved by name.
+    const std::string nodeDefName = "ND_standard_surface_surfaceshader";
+    REQUIRE(lazyDoc->hasDeferredElement(nodeDefName));
+    mx::NodeDefPtr nodeDef = lazyDoc->getNodeDef(nodeDefName);
+    REQUIRE(nodeDef);
+    REQUIRE(!lazyDoc->hasDeferredElement(nodeDefName));
+    REQUIRE(*nodeDef == *eagerDoc->getNodeDef(nodeDefName));
+    REQUIRE(nodeDef->getSourceUri() == eagerDoc->getNodeDef(nodeDefName)->getSourceUri());
+    REQUIRE(lazyDoc->getChildrenOfType<mx::NodeDef>().size() == 1);
+
+    // Deferred elements are loaded as they are resolved by node and nodedef.
+    mx::InterfaceElementPtr impl = nodeDef->getImplementation();
+    REQUIRE(impl);
+    REQUIRE(*impl == *eagerDoc->getNodeDef(nodeDefName)->getImplementation());
+    REQUIRE(lazyDoc->getMatchingNodeDefs("image").size() == eagerDoc->getMatchingNodeDefs("image").size());
+    mx::NodePtr node = lazyDoc->addNode("add", "add1", "color3");
+    REQUIRE(node->getNodeDef());
+    REQUIRE(node->getNodeDef()->getName() == "ND_add_color3");
+    REQUIRE(node->getImplementation());
+    lazyDoc->removeNode(node->getName());
+
+    // Loading all deferred elements reproduces the eagerly read document.
+    lazyDoc->loadDeferredElements();
+    REQUIRE(lazyDoc->getDeferredElementCount() == 0);
+    REQUIRE(lazyDoc->getChildren().size() == eagerDoc->getChildren().size());
+    for (mx::ElementPtr child : eagerDoc->getChildren())
+    {
+        mx::ElementPtr lazyChild = lazyDoc->getChild(child->getName());
+        REQUIRE(lazyChild);
+        REQUIRE(*lazyChild == *child);
+        REQUIRE(lazyChild->getSourceUri() == child->getSourceUri());
+    }
+    REQUIRE(lazyDoc->validate());
+
+    // Deferred elements are carried through document copies.
+    mx::DocumentPtr copiedDoc = mx::createDocument();
+    mx::readFromXmlString(copiedDoc, xml, &readOptions);
+    copiedDoc = copiedDoc->copy();
+    REQUIRE(copiedDoc->getDeferredElementCount() > 0);
+    REQUIRE(copiedDoc->getNodeDef(nodeDefName));
+    mx::DocumentPtr observedDoc = mx::Document::createDocument<mx::ObservedDocument>();
+    mx::readFromXmlString(observedDoc, xml, &readOptions);
+    observedDoc = observedDoc->copy();
+    REQUIRE(observedDoc->getDeferredElementCount() > 0);
+    REQUIRE(observedDoc->getNodeDef(nodeDefName));
+
+    // Deferred elements are loaded before a document is imported as a
+    // library.
+    mx::DocumentPtr libraryDoc = mx::createDocument();
+    mx::readFromXmlString(libraryDoc, xml, &readOptions);
+    mx::DocumentPtr importDoc = mx::createDocument();
+    importDoc->importLibrary(libraryDoc);
+    REQUIRE(importDoc->getChildren().size() == eagerDoc->getChildren().size());
+
+    // Maintenance of the document cache leaves deferred elements unloaded.
+    mx::DocumentPtr namespaceDoc = mx::createDocument();
+    mx::readFromXmlString(namespaceDoc, xml, &readOptions);
+    REQUIRE(namespaceDoc->getNodeDef(nodeDefName));
+    size_t deferredCount = namespaceDoc->getDeferredElementCount();
+    namespaceDoc->setNamespace("ns");
+    namespaceDoc->removeAttribute(mx::Element::NAMESPACE_ATTRIBUTE);
+    REQUIRE(namespaceDoc->getNodeDef(nodeDefName));
+    REQUIRE(namespaceDoc->getDeferredElementCount() == deferredCount);
+
+    // Deferred elements are loaded before lookups of all elements of a
+    // category, traversals, and writing.
+    mx::DocumentPtr listDoc = mx::createDocument();
+    mx::readFromXmlString(listDoc, xml, &readOptions);
+    REQUIRE(listDoc->getNodeDefs().size() == eagerDoc->getNodeDefs().size());
+    REQUIRE(listDoc->getImplementations().size() == eagerDoc->getImplementations().size());
+    REQUIRE(listDoc->getNodeGraphs().size() == eagerDoc->getNodeGraphs().size());
+    mx::DocumentPtr traverseDoc = mx::createDocument();
+    mx::readFromXmlString(traverseDoc, xml, &readOptions);
+    size_t traverseCount = 0;
+    for (mx::ElementPtr elem : traverseDoc->traverseTree())
+    {
+        traverseCount += elem->isA<mx::NodeDef>();
+    }
+    REQUIRE(traverseCount == eagerDoc->getNodeDefs().size());
+    mx::DocumentPtr writeDoc = mx::createDocument();
+    mx::readFromXmlString(writeDoc, xml, &readOptions);
+    mx::XmlWriteOptions writeOptions;
+    writeOptions.writeXIncludeEnable = false;
+    mx::DocumentPtr writtenDoc = mx::createDocument();
+    mx::readFromXmlString(writtenDoc, mx::writeToXmlString(writeDoc, &writeOptions));
+    REQUIRE(writtenDoc->getChildren().size() == eagerDoc->getChildren().size());
+
+    // Validate documents containing a nodegraph whose nodedef is still
+    // deferred, serially and in parallel.
+    mx::NodeGraphPtr eagerGraph = eagerDoc->getNodeGraph("IMPL_standard_surface_surfaceshader");
+    REQUIRE(eagerGraph);
+    for (unsigned int threadCount : { 0u, 4u })
+    {
+        mx::DocumentPtr validateDoc = mx::createDocument();
+        mx::readFromXmlString(validateDoc, xml, &readOptions);
+        mx::NodeGraphPtr graphCopy = validateDoc->addNodeGraph("NG_standard_surface_copy");
+        graphCopy->copyContentFrom(eagerGraph);
+        REQUIRE(validateDoc->hasDeferredElement(graphCopy->getNodeDefString()));
+        std::string message;
+        bool valid = threadCount ? validateDoc->validateParallel(&message, threadCount) : validateDoc->validate(&message);
+        INFO(message);
+        REQUIRE(valid);
+        REQUIRE(validateDoc->getDeferredElementCount() == 0);
+    }
+}
+
+TEST_CASE("Deferred library elements benchmark", "[xmlio][benchmark][.]")
+{
+    const int ROUND_COUNT = 5;
+
+    // Read a standard_surface material along with all data libraries.
+    mx::FilePathVec files = getDocumentsInTree("libraries");
+    files.push_back("resources/Materials/Examples/StandardSurface/standard_surface_default.mtlx");
+    std::string xml = getXIncludeDocument(files);
+
+    for (bool deferred : { false, true })
+    {
+        mx::XmlReadOptions readOptions;
+        readOptions.deferLibraryElements = deferred;
+        double readTime = 0.0;
+        double resolveTime = 0.0;
+        size_t elementCount = 0;
+        for (int round = 0; round < ROUND_COUNT; round++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            mx::DocumentPtr doc = mx::createDocument();
+            mx::readFromXmlString(doc, xml, &readOptions);
+            auto read = std::chrono::steady_clock::now();
+
+            // Resolve the nodedefs and implementations used by the material.
+            std::vector<mx::InterfaceElementPtr> pending;
+            for (mx::MaterialPtr material : doc->getMaterials())
+            {
+                for (mx::ShaderRefPtr shaderRef : material->getShaderRefs())
+                {
+                    pending.push_back(shaderRef->getNodeDef()->getImplementation());
+                }
+            }
+            while (!pending.empty())
+            {
+                mx::NodeGraphPtr graph = pending.back() ? pending.back()->asA<mx::NodeGraph>() : nullptr;
+                pending.pop_back();
+                for (mx::NodePtr graphNode : graph ? graph->getNodes() : std::vector<mx::NodePtr>())
+                {
+                    pending.push_back(graphNode->getImplementation());
+                }
+            }
+            auto resolved = std::chrono::steady_clock::now();
+
+            readTime += std::chrono::duration<double, std::milli>(read - start).count();
+            resolveTime += std::chrono::duration<double, std::milli>(resolved - read).count();
+            elementCount = 0;
+            for (mx::ElementPtr elem : doc->traverseTree())
+            {
+                elementCount++;
+            }
+        }
+
+        std::cout << "standard_surface " << (deferred ? "with" : "without") << " deferred library elements: " <<
+            readTime / ROUND_COUNT << " ms read, " << resolveTime / ROUND_COUNT << " ms resolve, " <<
+            elementCount << " elements" << std::endl;
+    }
+}
+
+TEST_CASE("Streaming write", "[xmlio]")
+{
+    // Write a document exercising attribute escaping, anonymous names, and XIncludes.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::ElementPtr generic = doc->addChildOfCategory("generic", "generic1");
+    generic->setAttribute("text", "a&b\"c<d>e\ng\rh");
+    generic->setAttribute("empty", mx::EMPTY_STRING);
+    generic->addChildOfCategory("child", "child1");
+    doc->addChildOfCategory(mx::EMPTY_STRING, "anonymous1");
+    doc->addChildOfCategory("nodedef", "ND_include1")->setSourceUri("include/first.mtlx");
+    doc->addChildOfCategory("nodedef", "ND_include2")->setSourceUri("include/first.mtlx");
+    doc->addChildOfCategory("nodedef", "ND_include3")->setSourceUri("include/second.mtlx");
+
+    std::string expected =
+        "<?xml version=\"1.0\"?>\n"
+        "<materialx version=\"1.37\" xmlns:xi=\"http://www.w3.org/2001/XInclude\">\n"
+        "  <generic name=\"generic1\" text=\"a&amp;b&quot;c<d>e&#10;g&#13;h\" empty=\"\">\n"
+        "    <child name=\"child1\" />\n"
+        "  </generic>\n"
+        "  <:anonymous name=\"anonymous1\" />\n"
+        "  <xi:include href=\"include/first.mtlx\" />\n"
+        "  <xi:include href=\"include/second.mtlx\" />\n"
+        "</materialx>\n";
+    REQUIRE(mx::writeToXmlString(doc) == expected);
+
+    // Write without XIncludes, filtering out child elements.
+    mx::XmlWriteOptions writeOptions;
+    writeOptions.writeXIncludeEnable = false;
+    writeOptions.elementPredicate = [](mx::ConstElementPtr elem)
+    {
+        return elem->getCategory() != "child";
+    };
+    std::string xml = mx::writeToXmlString(doc, &writeOptions);
+    REQUIRE(xml.find("<generic name=\"generic1\" text=") != std::string::npos);
+    REQUIRE(xml.find("<child") == std::string::npos);
+    REQUIRE(xml.find("xi:include") == std::string::npos);
+    REQUIRE(xml.find("<nodedef name=\"ND_include3\" />") != std::string::npos);
+
+    // Verify that written documents are read back and rewritten unchanged.
+    mx::DocumentPtr readDoc = mx::createDocument();
+    mx::readFromXmlString(readDoc, xml);
+    REQUIRE(readDoc->getChild("generic1")->getAttribute("text") == generic->getAttribute("text"));
+    REQUIRE(readDoc->getChildren().size() == doc->getChildren().size());
+    mx::FileSearchPath searchPath("libraries/stdlib");
+    writeOptions.elementPredicate = nullptr;
+    for (const mx::FilePath& file : getDocumentsInTree("resources/Materials/TestSuite"))
+    {
+        mx::DocumentPtr origDoc = mx::createDocument();
+        mx::readFromXmlFile(origDoc, file, searchPath);
+        xml = mx::writeToXmlString(origDoc, &writeOptions);
+        mx::DocumentPtr copyDoc = mx::createDocument();
+        mx::readFromXmlString(copyDoc, xml);
+        REQUIRE(mx::writeToXmlString(copyDoc, &writeOptions) == xml);
+    }
+}
+
+TEST_CASE("Large document benchmark", "[xmlio][benchmark][.]")
+{
+    const int COPY_COUNT = 50;
+    const int ROUND_COUNT = 5;
+
+    // Write a large document containing many copies of the standard library.
+    mx::DocumentPtr largeDoc = XmlIoUtil::createLargeDocument(COPY_COUNT);
+    mx::FilePath filename("large_document.mtlx");
+    mx::writeToXmlFile(largeDoc, filename);
+
+    double readTime = 0.0;
+    for (int round = 0; round < ROUND_COUNT; round++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        mx::DocumentPtr doc = mx::createDocument();
+        mx::readFromXmlFile(doc, filename);
+        auto end = std::chrono::steady_clock::now();
+        readTime += std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    std::remove(filename.asString().c_str());
+
+    double writeTime = 0.0;
+    for (int round = 0; round < ROUND_COUNT; round++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        mx::writeToXmlFile(largeDoc, filename);
+        auto end = std::chrono::steady_clock::now();
+        writeTime += std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    std::remove(filename.asString().c_str());
+
+    std::cout << "Large document with " << largeDoc->getChildren().size() << " top-level elements: " <<
+        readTime / ROUND_COUNT << " ms read, " << writeTime / ROUND_COUNT << " ms write" << std::endl;
+}
@@ -0,0 +1,56 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXTest/XmlIoUtil.h>
+
+#include <MaterialXFormat/XmlIo.h>
+
+namespace mx = MaterialX;
+
+namespace XmlIoUtil
+{
+
+mx::FilePathVec getDocumentsInTree(const mx::FilePath& rootPath)
+{
+    mx::FilePathVec files;
+    for (const mx::FilePath& dir : rootPath.getSubDirectories())
+    {
+        for (const mx::FilePath& file : dir.getFilesInDirectory(mx::MTLX_EXTENSION))
+        {
+            files.push_back(dir / file);
+        }
+    }
+    return files;
+}
+
+std::string getXIncludeDocument(const mx::FilePathVec& files)
+{
+    std::string xml = "<?xml version=\"1.0\"?>\n"
+                      "<materialx version=\"1.37\" xmlns:xi=\"http://www.w3.org/2001/XInclude\">\n";
+    for (const mx::FilePath& file : files)
+    {
+        xml += "  <xi:include href=\"" + file.asString(mx::FilePath::FormatPosix) + "\" />\n";
+    }
+    xml += "</materialx>\n";
+    return xml;
+}
+
+mx::DocumentPtr createLargeDocument(int copyCount)
+{
+    mx::DocumentPtr library = mx::createDocument();
+    mx::readFromXmlFile(library, "libraries/stdlib/stdlib_defs.mtlx");
+    mx::DocumentPtr largeDoc = mx::createDocument();
+    for (int i = 0; i < copyCount; i++)
+    {
+        for (mx::ElementPtr child : library->getChildren())
+        {
+            std::string name = "copy" + std::to_string(i) + "_" + child->getName();
+            largeDoc->addChildOfCategory(child->getCategory(), name)->copyContentFrom(child);
+        }
+    }
+    return largeDoc;
+}
+
+} // namespace XmlIoUtil
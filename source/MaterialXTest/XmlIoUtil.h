@@ -0,0 +1,30 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef XMLIO_UTIL_H
+#define XMLIO_UTIL_H
+
+#include <MaterialXCore/Document.h>
+
+#include <MaterialXFormat/File.h>
+
+namespace mx = MaterialX;
+
+namespace XmlIoUtil
+{
+
+/// Return the paths of all MaterialX documents in the given directory tree.
+mx::FilePathVec getDocumentsInTree(const mx::FilePath& rootPath);
+
+/// Return an XML document string that includes each of the given files.
+std::string getXIncludeDocument(const mx::FilePathVec& files);
+
+/// Return a large document containing the given number of copies of the
+/// standard library definitions.
+mx::DocumentPtr createLargeDocument(int copyCount);
+
+} // namespace XmlIoUtil
+
+#endif
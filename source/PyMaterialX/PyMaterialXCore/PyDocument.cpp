@@ -20,6 +20,16 @@ void bindPyDocument(py::module& mod)
         .def("importLibrary", &mx::Document::importLibrary,
             py::arg("library"), py::arg("copyOptions") = (const mx::CopyOptions*) nullptr)
         .def("getReferencedSourceUris", &mx::Document::getReferencedSourceUris)
+        .def("getRevision", &mx::Document::getRevision)
+        .def("setDataLibrary", &mx::Document::setDataLibrary)
+        .def("getDataLibrary", &mx::Document::getDataLibrary)
+        .def("hasDataLibrary", &mx::Document::hasDataLibrary)
+        .def("freeze", &mx::Document::freeze)
+        .def("isFrozen", &mx::Document::isFrozen)
+        .def("hasDeferredElement", &mx::Document::hasDeferredElement)
+        .def("getDeferredElementCount", &mx::Document::getDeferredElementCount)
+        .def("loadDeferredElement", &mx::Document::loadDeferredElement)
+        .def("loadDeferredElements", &mx::Document::loadDeferredElements)
         .def("addNodeGraph", &mx::Document::addNodeGraph,
             py::arg("name") = mx::EMPTY_STRING)
         .def("getNodeGraph", &mx::Document::getNodeGraph)
@@ -92,6 +102,12 @@ void bindPyDocument(py::module& mod)
         .def("getUnitTypeDef", &mx::Document::getUnitTypeDef)
         .def("getUnitTypeDefs", &mx::Document::getUnitTypeDefs)
         .def("removeUnitTypeDef", &mx::Document::removeUnitTypeDef)
+        .def("validateParallel", [](mx::Document& doc, unsigned int threadCount)
+            {
+                std::string message;
+                bool res = doc.validateParallel(&message, threadCount);
+                return std::pair<bool, std::string>(res, message);
+            }, py::arg("threadCount") = 0)
         .def("upgradeVersion", &mx::Document::upgradeVersion)
         .def("setColorManagementSystem", &mx::Document::setColorManagementSystem)
         .def("hasColorManagementSystem", &mx::Document::hasColorManagementSystem)
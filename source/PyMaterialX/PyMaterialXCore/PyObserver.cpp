@@ -17,6 +17,7 @@ void bindPyObserver(py::module& mod)
         .def("onRemoveElement", &mx::Observer::onRemoveElement)
         .def("onSetAttribute", &mx::Observer::onSetAttribute)
         .def("onRemoveAttribute", &mx::Observer::onSetAttribute)
+        .def("onSetChildOrder", &mx::Observer::onSetChildOrder)
         .def("onCopyContent", &mx::Observer::onCopyContent)
         .def("onClearContent", &mx::Observer::onClearContent)
         .def("onRead", &mx::Observer::onRead)
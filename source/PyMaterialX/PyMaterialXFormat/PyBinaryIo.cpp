@@ -0,0 +1,20 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <PyMaterialX/PyMaterialX.h>
+
+#include <MaterialXFormat/BinaryIo.h>
+#include <MaterialXCore/Document.h>
+
+namespace py = pybind11;
+namespace mx = MaterialX;
+
+void bindPyBinaryIo(py::module& mod)
+{
+    mod.def("readFromBinaryFile", &mx::readFromBinaryFile,
+        py::arg("doc"), py::arg("filename"), py::arg("searchPath") = mx::FileSearchPath());
+    mod.def("writeToBinaryFile", &mx::writeToBinaryFile,
+        py::arg("doc"), py::arg("filename"));
+}
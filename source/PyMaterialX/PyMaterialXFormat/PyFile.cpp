@@ -39,6 +39,7 @@ void bindPyFile(py::module& mod)
         .def("getExtension", &mx::FilePath::getExtension)
         .def("exists", &mx::FilePath::exists)
         .def("isDirectory", &mx::FilePath::isDirectory)
+        .def("getModificationTime", &mx::FilePath::getModificationTime)
         .def("getFilesInDirectory", &mx::FilePath::getFilesInDirectory)
         .def("getSubDirectories", &mx::FilePath::getSubDirectories)
         .def("createDirectory", &mx::FilePath::createDirectory)
@@ -7,6 +7,7 @@
 
 namespace py = pybind11;
 
+void bindPyBinaryIo(py::module& mod);
 void bindPyFile(py::module& mod);
 void bindPyXmlIo(py::module& mod);
 
@@ -15,5 +16,6 @@ PYBIND11_MODULE(PyMaterialXFormat, mod)
     mod.doc() = "Module containing Python bindings for the MaterialXFormat library";
 
     bindPyFile(mod);
+    bindPyBinaryIo(mod);
     bindPyXmlIo(mod);
 }
@@ -16,7 +16,18 @@ void bindPyXmlIo(py::module& mod)
     py::class_<mx::XmlReadOptions, mx::CopyOptions>(mod, "XmlReadOptions")
         .def(py::init())
         .def_readwrite("readXIncludeFunction", &mx::XmlReadOptions::readXIncludeFunction)
-        .def_readwrite("parentXIncludes", &mx::XmlReadOptions::parentXIncludes);
+        .def_readwrite("parentXIncludes", &mx::XmlReadOptions::parentXIncludes)
+        .def_readwrite("parallelXIncludes", &mx::XmlReadOptions::parallelXIncludes)
+        .def_readwrite("threadCount", &mx::XmlReadOptions::threadCount)
+        .def_readwrite("xincludeCache", &mx::XmlReadOptions::xincludeCache)
+        .def_readwrite("deferLibraryElements", &mx::XmlReadOptions::deferLibraryElements);
+
+    py::class_<mx::XIncludeCache, mx::XIncludeCachePtr>(mod, "XIncludeCache")
+        .def_static("create", &mx::XIncludeCache::create)
+        .def("getDocumentCount", &mx::XIncludeCache::getDocumentCount)
+        .def("clear", &mx::XIncludeCache::clear)
+        .def("getHitCount", &mx::XIncludeCache::getHitCount)
+        .def("getMissCount", &mx::XIncludeCache::getMissCount);
 
     py::class_<mx::XmlWriteOptions>(mod, "XmlWriteOptions")
         .def(py::init())